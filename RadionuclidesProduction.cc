@@ -31,7 +31,7 @@
 #include "G4Types.hh"
 
 #ifdef G4MULTITHREADED
-#include "G4MTRunManager.hh"
+#include "G4TaskRunManager.hh"
 #else
 #include "G4RunManager.hh"
 #endif
@@ -42,16 +42,37 @@
 #include "DetectorConstruction.hh"
 #include "G4PhysListFactory.hh"
 #include "ActionInitialization.hh"
+#include "ShardRunManager.hh"
 #include "SteppingVerbose.hh"
+#include "PhysicsTableCache.hh"
 
 #include "G4UIExecutive.hh"
 #include "G4VisExecutive.hh"
 
 #include "G4ParticleHPManager.hh"
 
+#include <cstdlib>
+#include <vector>
+
 
 int main(int argc, char** argv) {
 
+  //events per task of the tasking run manager: option -g N
+  G4int grain = 0;
+  std::vector<char*> args;
+  for (G4int i=0; i<argc; i++) {
+    if (G4String(argv[i]) == "-g" && i+1 < argc)
+      grain = G4UIcommand::ConvertToInt(argv[++i]);
+    else args.push_back(argv[i]);
+  }
+  argc = args.size();
+  argv = args.data();
+  if (argc != 1 && argc != 2 && argc != 3 && argc != 5) {
+    G4cerr << "usage : " << argv[0] << " [-g eventsPerTask]"
+           << " [macro [nThreads [shardIndex nbShards]]]" << G4endl;
+    return 1;
+  }
+
   //detect interactive mode (if no arguments) and define UI session
   G4UIExecutive* ui = nullptr;
   if (argc == 1) ui = new G4UIExecutive(argc,argv);
@@ -59,16 +80,22 @@ int main(int argc, char** argv) {
   //choose the Random engine
   G4Random::setTheEngine(new CLHEP::RanecuEngine);
 
-  //construct the default run manager
+  //construct the default run manager: the threads pull tasks of events,
+  //which balances the very different costs of the GCR events;
+  //G4RUN_MANAGER_TYPE=MT restores the static event batches
 #ifdef G4MULTITHREADED
-  G4MTRunManager* runManager = new G4MTRunManager;
+  G4MTRunManager* runManager = 0;
+  const char* type = std::getenv("G4RUN_MANAGER_TYPE");
+  if (type && G4String(type) == "MT") runManager = new ShardRunManager<G4MTRunManager>;
+  else runManager = new ShardRunManager<G4TaskRunManager>;
+  if (grain > 0) runManager->SetEventModulo(grain);
   G4int nThreads = G4Threading::G4GetNumberOfCores();
-  if (argc==3) nThreads = G4UIcommand::ConvertToInt(argv[2]);
+  if (argc>=3) nThreads = G4UIcommand::ConvertToInt(argv[2]);
   runManager->SetNumberOfThreads(nThreads);
 #else
   //my Verbose output class
   G4VSteppingVerbose::SetInstance(new SteppingVerbose);
-  G4RunManager* runManager = new G4RunManager;
+  G4RunManager* runManager = new ShardRunManager<G4RunManager>;
 #endif
 
   //set mandatory initialization classes
@@ -79,6 +106,9 @@ int main(int argc, char** argv) {
   G4PhysListFactory *physListFactory = new G4PhysListFactory();
   G4VUserPhysicsList *physicsList = physListFactory->GetReferencePhysList("Shielding");
   runManager->SetUserInitialization(physicsList);
+
+  //startup times, and cache of the physics tables (/testhadr/phys/tableCache)
+  PhysicsTableCache* tableCache = new PhysicsTableCache(physicsList, "Shielding");
   runManager->SetUserInitialization(new ActionInitialization(det));
 
   // Replaced HP environmental variables with C++ calls
@@ -103,6 +133,11 @@ int main(int argc, char** argv) {
   //get the pointer to the User Interface manager
   G4UImanager* UImanager = G4UImanager::GetUIpointer();
 
+  //shard of a larger job: macro nThreads shardIndex nbShards
+  if (argc==5) {
+    UImanager->ApplyCommand(G4String("/checkpoint/shard ") + argv[3] + " " + argv[4]);
+  }
+
   if (ui)  {
    //interactive mode
    visManager = new G4VisExecutive;
@@ -119,6 +154,7 @@ int main(int argc, char** argv) {
 
   //job termination
   delete visManager;
+  delete tableCache;
   delete runManager;
 
   return 0;
@@ -0,0 +1,242 @@
+#!/usr/bin/env python3
+"""Fold a primary spectrum with the response matrix of RadionuclidesProduction.
+
+The matrix (<fileName>_response.bin, written with /scoring/response/grid and
+/source/mode grid) gives, for every primary kinetic energy of a log grid, the
+number of scored radionuclides per primary in each depth bin. Folding it with
+a differential spectrum J(E) in particles/(MeV m2 sr s) gives the production
+rate and the activity (dpm/kg) of every depth bin, without a new simulation:
+
+    rate(x) = G * sum_k Y_k(x) * integral of J over the log bin of point k
+
+with G the geometry factor of the run. Several matrices (e.g. protons and
+alphas) can be folded at once; their activities are added.
+
+Examples:
+    fold_response.py --gcr 600 p_response.bin a_response.bin
+    fold_response.py --scr 100 100 10 p_response.bin
+    fold_response.py --table scr.txt p_response.bin --exposure 1e6
+"""
+
+import argparse
+import struct
+import sys
+
+import numpy as np
+
+PROTON = 2212
+ALPHA = 1000020040
+YEAR = 365.25*24*3600.
+
+
+def read_response(path):
+    """Read a response matrix file in a dict."""
+    with open(path, "rb") as f:
+        data = f.read()
+    version = data[:8]
+    if version not in (b"RNRESP01", b"RNRESP02"):
+        raise ValueError(path + ": not a response matrix")
+    pos = 8
+
+    def take(fmt, n=1):
+        nonlocal pos
+        values = struct.unpack_from("=" + fmt*n, data, pos)
+        pos += struct.calcsize("=" + fmt*n)
+        return values if n > 1 else values[0]
+
+    m = {"file": path}
+    nb_points, nb_nuclides = take("i"), take("i")
+    m["pdg"], m["surface"] = take("i"), bool(take("i"))
+    m["emin"], m["emax"] = take("d"), take("d")
+    # RNRESP01: a single density, the bin masses are computed from it
+    m["radius"] = take("d")
+    density = take("d") if version == b"RNRESP01" else None
+    m["geometry"] = take("d")
+    m["primaries"] = np.array(take("q", nb_points), ndmin=1)
+
+    nuclides = []
+    for _ in range(nb_nuclides):
+        Z, A, nbins = take("i"), take("i"), take("i")
+        tau = take("d")
+        edges = np.array(take("d", nbins + 1), ndmin=1) if nbins > 0 else np.zeros(0)
+        if nbins == 0:
+            mass = np.zeros(0)
+        elif density is None:
+            mass = np.array(take("d", nbins), ndmin=1)
+        else:
+            R = m["radius"]
+            rmax = R - np.maximum(edges[:-1], 0.)
+            rmin = R - np.minimum(edges[1:], R)
+            mass = 4./3*np.pi*np.maximum(rmax**3 - rmin**3, 0.)*density/1000.
+        nuclides.append({"Z": Z, "A": A, "tau": tau, "edges": edges, "mass": mass})
+    for nuc in nuclides:
+        nbins = len(nuc["edges"]) - 1 if len(nuc["edges"]) else 0
+        y = np.zeros((nb_points, nbins))
+        e = np.zeros((nb_points, nbins))
+        for p in range(nb_points):
+            if nbins > 0:
+                y[p] = take("d", nbins)
+                e[p] = take("d", nbins)
+        nuc["yield"], nuc["error"] = y, e
+    m["nuclides"] = nuclides
+    m["energies"] = grid_energies(m["emin"], m["emax"], nb_points)
+    return m
+
+
+def grid_energies(emin, emax, n):
+    if n == 1:
+        return np.array([emin])
+    return emin*(emax/emin)**(np.arange(n)/(n - 1.))
+
+
+def gcr_proton(E, phi):
+    # GCRSpectrum::ProtonFlux
+    A, mp = 9.9e8, 938.27208816
+    x = 780.*np.exp(-2.5e-4*E)
+    return A*E*(E + 2*mp)*(E + x + phi)**-2.65/((E + phi)*(E + 2*mp + phi))
+
+
+def gcr_alpha(E, phi):
+    # GCRSpectrum::AlphaFlux
+    C, m = 5.5e7, 3727.379378
+    k = phi*1.786e-3 - 0.1323
+    return (C*E**k*(E + 2*m)
+            / ((E + 700.)*(E + 2*m + 700.)*(E + 312500.*E**-2.5 + 700.)**(1.65 + k)))
+
+
+MASS = {PROTON: (938.27208816, 1), ALPHA: (3727.379378, 2)}
+
+
+def scr_spectrum(pdg, r0, flux, above):
+    """Exponential rigidity SCR spectrum, as SCRSpectrum: J(>R) = J0 exp(-R/R0),
+    with the omnidirectional flux (particles/(cm2 s)) above a kinetic energy."""
+    m, z = MASS[pdg]
+
+    def rigidity(E):
+        return np.sqrt(E*(E + 2*m))/z
+
+    j0 = flux/(4*np.pi)*1.e4*np.exp(rigidity(above)/r0)   # /(m2 sr s)
+
+    def spectrum(E):
+        r = rigidity(E)
+        return j0/r0*np.exp(-r/r0)*(E + m)/(r*z*z)
+    return spectrum
+
+
+def table_spectrum(path):
+    """J(E) from a two-column file E (MeV), J, log-log interpolated."""
+    E, J = np.loadtxt(path, usecols=(0, 1), unpack=True)
+    order = np.argsort(E)
+    logE, logJ = np.log(E[order]), np.log(np.maximum(J[order], 1e-300))
+
+    def flux(x):
+        x = np.asarray(x, dtype=float)
+        j = np.exp(np.interp(np.log(x), logE, logJ))
+        return np.where((x < E.min()) | (x > E.max()), 0., j)
+    return flux
+
+
+def point_weights(energies, flux, nsub=16):
+    """Integral of J over the log bin of each grid point, in /(m2 sr s)."""
+    n = len(energies)
+    if n < 2:
+        raise ValueError("the response grid needs at least 2 points")
+    h = np.log(energies[-1]/energies[0])/(n - 1)
+    w = np.zeros(n)
+    for k, ek in enumerate(energies):
+        lo = np.log(ek) - (0. if k == 0 else h/2)
+        hi = np.log(ek) + (0. if k == n - 1 else h/2)
+        u = np.linspace(lo, hi, nsub + 1)
+        f = flux(np.exp(u))*np.exp(u)          # J dE = J E dlnE
+        w[k] = np.sum((f[1:] + f[:-1])/2)*(u[1] - u[0])
+    return w
+
+
+def fold(m, flux, exposure):
+    """Production rate and activity of every nuclide and depth bin."""
+    w = point_weights(m["energies"], flux)
+    results = []
+    for nuc in m["nuclides"]:
+        edges = nuc["edges"]
+        if len(edges) == 0:
+            continue
+        # atoms/s in each bin, then per kg and per minute
+        rate = m["geometry"]*w @ nuc["yield"]
+        err = m["geometry"]*np.sqrt((w**2) @ nuc["error"]**2)
+        mass = nuc["mass"]
+        norm = np.where(mass > 0., 60./np.where(mass > 0., mass, 1.), 0.)
+        fraction = 0.
+        if nuc["tau"] > 0.:
+            fraction = 1. if exposure <= 0. else 1. - np.exp(-exposure/nuc["tau"])
+        results.append({"Z": nuc["Z"], "A": nuc["A"], "edges": edges,
+                        "rate": rate*norm, "rate_err": err*norm,
+                        "activity": rate*norm*fraction,
+                        "activity_err": err*norm*fraction})
+    return results, w.sum()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Fold a GCR or SCR spectrum with response matrices")
+    parser.add_argument("matrices", nargs="+", help="<fileName>_response.bin files")
+    source = parser.add_mutually_exclusive_group(required=True)
+    source.add_argument("--gcr", type=float, metavar="PHI",
+                        help="force-field GCR spectrum of each species, phi in MeV")
+    source.add_argument("--scr", type=float, nargs=3, metavar=("R0", "FLUX", "E"),
+                        help="SCR spectrum: R0 in MV, 4pi flux in 1/(cm2 s) above E in MeV")
+    source.add_argument("--table", action="append", metavar="FILE",
+                        help="spectrum E(MeV) J(1/(MeV m2 sr s)), once per matrix")
+    parser.add_argument("--exposure", type=float, default=0., metavar="YEARS",
+                        help="exposure time (default 0: saturation)")
+    parser.add_argument("-o", "--output", help="output file (default stdout)")
+    args = parser.parse_args()
+
+    if args.table and len(args.table) != len(args.matrices):
+        parser.error("one --table per matrix")
+
+    total = {}
+    for i, path in enumerate(args.matrices):
+        m = read_response(path)
+        if args.gcr is not None:
+            if m["pdg"] == PROTON:
+                flux = lambda E: gcr_proton(E, args.gcr)
+            elif m["pdg"] == ALPHA:
+                flux = lambda E: gcr_alpha(E, args.gcr)
+            else:
+                parser.error(path + ": no GCR spectrum for PDG code %d" % m["pdg"])
+        elif args.scr is not None:
+            if m["pdg"] not in MASS:
+                parser.error(path + ": no SCR spectrum for PDG code %d" % m["pdg"])
+            flux = scr_spectrum(m["pdg"], *args.scr)
+        else:
+            flux = table_spectrum(args.table[i])
+        results, intensity = fold(m, flux, args.exposure*YEAR)
+        print("%s : %d primaries, %.4g - %.4g MeV, intensity %.4g /(m2 sr s)"
+              % (path, m["primaries"].sum(), m["emin"], m["emax"], intensity),
+              file=sys.stderr)
+        for r in results:
+            key = (r["Z"], r["A"])
+            if key not in total:
+                total[key] = r
+                continue
+            t = total[key]
+            if not np.array_equal(t["edges"], r["edges"]):
+                parser.error(path + ": binning differs for Z=%d A=%d" % key)
+            for q in ("rate", "activity"):
+                t[q] = t[q] + r[q]
+                t[q + "_err"] = np.hypot(t[q + "_err"], r[q + "_err"])
+
+    out = open(args.output, "w") if args.output else sys.stdout
+    out.write("# Z A depth_min(cm) depth_max(cm) rate(atoms/(kg min)) rate_err"
+              " activity(dpm/kg) activity_err\n")
+    for (Z, A), r in sorted(total.items()):
+        for b in range(len(r["rate"])):
+            out.write("%d %d %g %g %.6g %.6g %.6g %.6g\n"
+                      % (Z, A, r["edges"][b], r["edges"][b + 1], r["rate"][b],
+                         r["rate_err"][b], r["activity"][b], r["activity_err"][b]))
+    if args.output:
+        out.close()
+
+
+if __name__ == "__main__":
+    main()
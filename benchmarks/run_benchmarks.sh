@@ -0,0 +1,50 @@
+#!/bin/sh
+# Runs the reference workloads and appends one JSON line per workload and
+# thread count to benchmarks/results.jsonl (or to $BENCH_RESULTS).
+#   run_benchmarks.sh <RadionuclidesProduction> [thread counts, default "1 2 4"]
+# Run from the build directory, where the energy macros are copied.
+
+EXE=${1:?usage: run_benchmarks.sh <RadionuclidesProduction> [threads...]}
+shift
+THREADS=${*:-"1 2 4"}
+HERE=$(cd "$(dirname "$0")" && pwd)
+RESULTS=${BENCH_RESULTS:-$HERE/results.jsonl}
+COMMIT=$(git -C "$HERE" rev-parse --short HEAD 2>/dev/null || echo unknown)
+FAILED=0
+
+for WORKLOAD in proton_1GeV gcr_bennu alpha; do
+  for NT in $THREADS; do
+    LOG=bench_${WORKLOAD}_${NT}.log
+    START=$(date +%s.%N)
+    "$EXE" "$HERE/bench_$WORKLOAD.mac" "$NT" > "$LOG" 2>&1
+    STATUS=$?
+    END=$(date +%s.%N)
+
+    # "Performance : events N steps S wallTime T events/s E steps/s R peakRSS(MB) M threads K"
+    PERF=$(grep "Performance :" "$LOG" | tail -1)
+    G4VERSION=$(grep -o "geant4-[0-9a-z-]*" "$LOG" | head -1)
+    # no step: the primaries did not reach the target, not a benchmark
+    STEPS=$(echo "$PERF" | awk '{for (i=1; i<NF; i++) if ($i == "steps") print $(i+1)}')
+    if [ -n "$PERF" ] && [ "${STEPS:-0}" = 0 ]; then
+      echo "{\"workload\": \"$WORKLOAD\", \"threads\": $NT, \"commit\": \"$COMMIT\", \"status\": $STATUS, \"error\": \"no step, see $LOG\"}" >> "$RESULTS"
+      echo "$WORKLOAD, $NT threads: failed, no step (see $LOG)"
+      FAILED=1
+      continue
+    fi
+    echo "$PERF" | awk -v w="$WORKLOAD" -v nt="$NT" -v c="$COMMIT" -v g="$G4VERSION" \
+      -v start="$START" -v end="$END" -v status="$STATUS" '
+      NF > 0 {
+        for (i=1; i<NF; i++) v[$i] = $(i+1)
+        total = end - start
+        printf("{\"workload\": \"%s\", \"threads\": %d, \"commit\": \"%s\", \"geant4\": \"%s\", ", w, nt, c, g)
+        printf("\"status\": %d, \"events\": %.0f, \"steps\": %.0f, \"runTime\": %g, ", status, v["events"], v["steps"], v["wallTime"])
+        printf("\"initTime\": %g, \"eventsPerSecond\": %g, \"stepsPerSecond\": %g, \"peakRSSMB\": %g}\n",
+               total - v["wallTime"], v["events/s"], v["steps/s"], v["peakRSS(MB)"])
+      }' >> "$RESULTS"
+    [ -z "$PERF" ] && FAILED=1
+    [ -z "$PERF" ] && echo "{\"workload\": \"$WORKLOAD\", \"threads\": $NT, \"commit\": \"$COMMIT\", \"status\": $STATUS, \"error\": \"no result, see $LOG\"}" >> "$RESULTS"
+    echo "$WORKLOAD, $NT threads: ${PERF:-failed (see $LOG)}"
+  done
+done
+
+exit $FAILED
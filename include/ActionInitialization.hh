@@ -33,6 +33,13 @@
 #include "G4VUserActionInitialization.hh"
 
 class DetectorConstruction;
+class NuclideScorer;
+class ImportanceBiasing;
+class ProductionFilter;
+class Checkpoint;
+class Profiler;
+class SourceSpectrum;
+class MixedSource;
 class G4VSteppingVerbose;
 
 
@@ -46,9 +53,18 @@ class ActionInitialization : public G4VUserActionInitialization
     virtual void Build() const;
     
     virtual G4VSteppingVerbose* InitializeSteppingVerbose() const;
+
+    Checkpoint* GetCheckpoint() const {return fCheckpoint;};
    
   private:
     DetectorConstruction* fDetector;
+    NuclideScorer*        fScorer;
+    ImportanceBiasing*    fBiasing;
+    ProductionFilter*     fFilter;
+    Checkpoint*           fCheckpoint;
+    Profiler*             fProfiler;
+    SourceSpectrum*       fSpectrum;
+    MixedSource*          fMixed;
 };
 
 
@@ -0,0 +1,186 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Checkpoint.hh
+/// \brief Definition of the Checkpoint class
+
+#ifndef Checkpoint_h
+#define Checkpoint_h 1
+
+#include "globals.hh"
+#include "G4Timer.hh"
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <vector>
+
+class CheckpointMessenger;
+class DetectorConstruction;
+class NuclideScorer;
+class Run;
+
+// Long jobs run as a sequence of segments of /run/beamOn. The master sums
+// the Run of each segment; after a segment it writes the sum and the
+// status of its random engine, which drives the seeds of all events, in a
+// checkpoint file. A restart reads them back and runs the remaining
+// segments, giving the same events as the uninterrupted job. The results
+// are computed and written at the last segment only.
+// A job can also be one shard of a larger one: it runs its share of the
+// events of each /run/beamOn or /checkpoint/beamOn, with seeds derived at
+// its first run from the seeds of the engine (those of the macro) and the
+// shard index; its sum is written in the same format at the end of the
+// job, with the events of the whole job, to be merged with the other
+// shards.
+// An adaptive job (/run/beamUntil) has no fixed number of events: its
+// segments go on until the relative error of selected depth bins of a
+// nuclide histogram, computed on the sum of the segments, reaches a
+// target, or until its time budget is spent. Between two events, every
+// few events, each worker thread publishes the sums of the target bins of
+// its Run; they are added to the sum of the previous segments, and once
+// the target is reached (or the time spent) the threads end the segment
+// after their current event. The segments are long, at least
+// /checkpoint/minSegmentTime, so that the threads seldom wait for each
+// other at their end.
+// Configured and driven from the master; the worker threads only read
+// the state of the job at the beginning of each run, apart from the
+// snapshots of an adaptive job, which are locked.
+
+class Checkpoint
+{
+  public:
+    Checkpoint(DetectorConstruction*, NuclideScorer*);
+   ~Checkpoint();
+
+  public:
+    void SetFileName(const G4String& name) {fFileName = name;};
+    void SetEveryEvents(G4int n)           {fEveryEvents = n;};
+    void SetEveryTime(G4double t)          {fEveryTime = t;};
+
+    void BeamOn(G4int nbEvents);
+    void Restart(const G4String& fileName);
+
+    // segments until the largest relative error of the bins firstBin to
+    // lastBin of the nuclide histogram is below precision, within maxTime
+    // (0: no limit) and maxEvents (0: no limit)
+    void BeamUntil(G4double precision, const G4String& nuclide,
+                   G4int firstBin, G4int lastBin, G4double maxTime,
+                   G4int maxEvents);
+    G4bool IsAdaptive() const {return fTarget.fPrecision > 0.;};
+    void   SetMinSegmentTime(G4double t) {fMinSegmentTime = t;};
+    void   SetSnapshotEvents(G4int n)    {fSnapshotEvents = n;};
+    G4int  GetSnapshotEvents() const     {return fSnapshotEvents;};
+
+    // called by the worker threads between events of an adaptive job:
+    // sums of the target bins of their Run, and end of the segment
+    void   Snapshot(const Run*);
+    G4bool IsStopRequested() const {return fStop;};
+
+    // shard index of nbShards, with independent seeds of the engine
+    void   SetShard(G4int index, G4int nbShards);
+    G4bool IsShard() const {return fShard >= 0;};
+    // events of this shard out of the nbEvents of the job (all of them if
+    // the job is not sharded); derives the seeds at the first run
+    G4int  StartShard(G4int nbEvents);
+    void   WriteShard(const Run*);
+    void   Merge(const std::vector<G4String>& fileNames);
+
+    G4bool IsActive() const {return fActive;};
+    // an adaptive job knows its last segment only after it
+    G4bool IsLastSegment() const
+      {return !fActive || (!IsAdaptive() && fNbDone + fSegment >= fNbEvents);};
+    // file of the analysis manager for this segment ("" : the default)
+    G4String GetOutputFileName() const;
+
+    // sum of the segments, or 0 if the job is not finished
+    Run* EndOfSegment(const Run*);
+
+  private:
+    // precision target of an adaptive job; the time is the budget left
+    struct Target {
+      Target() : fPrecision(0.), fNuclide("-"), fFirstBin(0), fLastBin(0),
+                 fMaxTime(0.) {}
+      G4double fPrecision;
+      G4String fNuclide;
+      G4int    fFirstBin;
+      G4int    fLastBin;
+      G4double fMaxTime;
+    };
+
+    void RunSegments();
+    G4int NextSegment();
+    G4int TimedSegment(G4double period) const;
+    void StartSegment();
+    // sum of weights and of squared weights of the target bins
+    void TargetSums(const Run*, std::vector<G4double>&) const;
+    G4double LargestError(const std::vector<G4double>& sums, G4int& worstBin) const;
+    void Write();
+    void WriteFile(const G4String& fileName, const Run*, G4int nbDone,
+                   G4int nbEvents) const;
+    static std::istream& ReadHeader(std::istream&, G4int& nbDone, G4int& nbEvents,
+                                    G4int& shard, G4int& nbShards,
+                                    G4int& jobEvents, Target&);
+    void  SeedShard();
+    G4int ShardShare(G4int nbEvents) const;
+
+    DetectorConstruction* fDetector;
+    NuclideScorer*        fScorer;
+    G4String              fFileName;
+    G4int                 fEveryEvents;
+    G4double              fEveryTime;
+
+    G4bool                fActive;
+    G4int                 fNbEvents;
+    G4int                 fNbDone;
+    G4int                 fSegment;
+    G4String              fOutputName;
+    Run*                  fTotal;
+    G4Timer               fTimer;
+
+    Target                fTarget;
+    G4int                 fTargetIndex;
+    G4Timer               fJobTimer;
+    G4double              fJobTime;
+    G4double              fEventTime;
+    G4double              fMinSegmentTime;
+
+    // snapshots of the current segment, per thread
+    G4int                 fSnapshotEvents;
+    std::vector<G4double> fBaseSums;
+    std::map<G4int, std::vector<G4double> > fSnapshots;
+    std::atomic<G4bool>   fStop;
+    std::chrono::steady_clock::time_point fSegmentStart;
+
+    G4int                 fShard;
+    G4int                 fNbShards;
+    G4int                 fJobEvents;
+    G4bool                fShardSeeded;
+
+    CheckpointMessenger*  fCheckpointMessenger;
+};
+
+
+#endif
@@ -0,0 +1,71 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CheckpointMessenger.hh
+/// \brief Definition of the CheckpointMessenger class
+
+#ifndef CheckpointMessenger_h
+#define CheckpointMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class Checkpoint;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
+class G4UIcmdWithADoubleAndUnit;
+
+
+class CheckpointMessenger: public G4UImessenger
+{
+  public:
+
+    CheckpointMessenger(Checkpoint* );
+   ~CheckpointMessenger();
+
+    virtual void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+
+    Checkpoint*                fCheckpoint;
+
+    G4UIdirectory*             fCheckpointDir;
+    G4UIcmdWithAString*        fFileCmd;
+    G4UIcmdWithAnInteger*      fEveryEventsCmd;
+    G4UIcmdWithADoubleAndUnit* fEveryTimeCmd;
+    G4UIcmdWithAnInteger*      fBeamOnCmd;
+    G4UIcmdWithAString*        fRestartCmd;
+    G4UIcommand*               fShardCmd;
+    G4UIcmdWithAString*        fMergeCmd;
+    G4UIcommand*               fBeamUntilCmd;
+    G4UIcmdWithADoubleAndUnit* fMinSegmentTimeCmd;
+    G4UIcmdWithAnInteger*      fSnapshotEventsCmd;
+};
+
+
+#endif
@@ -32,6 +32,7 @@
 
 #include "G4VUserDetectorConstruction.hh"
 #include "globals.hh"
+#include <vector>
 
 class G4LogicalVolume;
 class G4Material;
@@ -55,6 +56,20 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     void SetRadius   (G4double);
     void SetMaterial (G4String);
 
+    // sweep over radii and materials in a single job
+    void SetSweepRadii     (const std::vector<G4double>&);
+    void SetSweepMaterials (const std::vector<G4String>&);
+    const std::vector<G4double>&    GetSweepRadii()     {return fSweepRadii;};
+    const std::vector<G4Material*>& GetSweepMaterials() {return fSweepMaterials;};
+    // primaries on the sphere surface whatever /source/position (sweeps)
+    void   SetSurfaceSource(G4bool surface) {fSurfaceSource = surface;};
+    G4bool IsSurfaceSource()                {return fSurfaceSource;};
+
+    // outer layer of the sphere in concentric shells, numbered from the
+    // surface; shell GetNbShells() is the core (copy numbers are shell+1)
+    void SetShells        (G4int nbShells, G4double depth, G4bool equalMass);
+    void SetShellMaterial (G4int first, G4int last, G4String);
+
   public:
                     
      G4double           GetRadius()     {return fRadius;};
@@ -62,6 +77,14 @@ class DetectorConstruction : public G4VUserDetectorConstruction
      G4Material*        GetMaterial()   {return fMaterial;};
      G4double           GetVolume();
 
+     G4int              GetNbShells()   {return fNbShells;};
+     G4double           GetShellRmin(G4int i)     {return fShellRadii[i+1];};
+     G4double           GetShellRmax(G4int i)     {return fShellRadii[i];};
+     G4Material*        GetShellMaterial(G4int i);
+     G4double           GetShellMass(G4int i);
+     // mass between two depths, with the density of each shell and the core
+     G4double           GetLayerMass(G4double depthMin, G4double depthMax);
+
      void               PrintParameters();
 
   private:
@@ -76,6 +99,17 @@ class DetectorConstruction : public G4VUserDetectorConstruction
      G4double           fWorldSize;
      G4Material*        fWorldMat;
      G4VPhysicalVolume* fPWorld;
+
+     std::vector<G4double>    fSweepRadii;
+     std::vector<G4Material*> fSweepMaterials;
+     G4bool                   fSurfaceSource;
+
+     G4int                         fNbShells;
+     G4double                      fShellDepth;
+     G4bool                        fEqualMass;
+     std::vector<G4Material*>      fShellMaterials;
+     std::vector<G4LogicalVolume*> fLShells;
+     std::vector<G4double>         fShellRadii;
      
      DetectorMessenger* fDetectorMessenger;
 
@@ -83,6 +117,7 @@ class DetectorConstruction : public G4VUserDetectorConstruction
     
      void               DefineMaterials();
      G4VPhysicalVolume* ConstructVolumes();
+     void               ComputeShells();
 };
 
 
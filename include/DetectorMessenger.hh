@@ -38,6 +38,7 @@ class DetectorConstruction;
 class G4UIdirectory;
 class G4UIcommand;
 class G4UIcmdWithAString;
+class G4UIcmdWithAnInteger;
 class G4UIcmdWithADoubleAndUnit;
 class G4UIcmdWithoutParameter;
 
@@ -51,6 +52,10 @@ class DetectorMessenger: public G4UImessenger
     
     virtual void SetNewValue(G4UIcommand*, G4String);
     
+  private:
+
+    void RunSweep(G4int nEvents, G4bool surface);
+
   private:
   
     DetectorConstruction*      fDetector;
@@ -60,6 +65,13 @@ class DetectorMessenger: public G4UImessenger
     G4UIcmdWithAString*        fMaterCmd;
     G4UIcmdWithADoubleAndUnit* fSizeCmd;
     G4UIcommand*               fIsotopeCmd;    
+    G4UIcommand*               fShellsCmd;
+    G4UIcommand*               fShellMatCmd;
+
+    G4UIdirectory*             fSweepDir;
+    G4UIcmdWithAString*        fSweepRadiiCmd;
+    G4UIcmdWithAString*        fSweepMatCmd;
+    G4UIcommand*               fSweepBeamOnCmd;
 };
 
 
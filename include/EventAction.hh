@@ -31,14 +31,48 @@
 #define EventAction_h 1
 
 #include "G4UserEventAction.hh"
+#include "G4Timer.hh"
 #include "globals.hh"
+#include <vector>
+
+class PrimaryGeneratorAction;
+class NuclideScorer;
+class Checkpoint;
 
 
 class EventAction : public G4UserEventAction
 {
   public:
-    EventAction();
+    EventAction(PrimaryGeneratorAction*, NuclideScorer*, Checkpoint*);
    ~EventAction();
+
+  public:
+    virtual void BeginOfEventAction(const G4Event*);
+    virtual void   EndOfEventAction(const G4Event*);
+
+    G4double GetPrimaryEnergy()       const {return fPrimaryEnergy;};
+    G4double GetPhiWeight(G4int iphi) const {return fPhiWeights[iphi];};
+    // point of the response grid of the primary energy, or -1
+    G4int    GetResponsePoint()       const {return fResponsePoint;};
+    // species of the primary in the mixed source, or -1
+    G4int    GetSpecies()             const {return fSpecies;};
+
+  private:
+    void ComputePhiNormalization();
+
+    PrimaryGeneratorAction* fPrimary;
+    NuclideScorer*          fScorer;
+    Checkpoint*             fCheckpoint;
+    G4int                   fNbSinceSnapshot;
+    G4double                fPrimaryEnergy;
+    G4int                   fResponsePoint;
+    G4int                   fSpecies;
+    G4Timer                 fTimer;
+
+    // reweighting of the reference GCR spectrum to the /scoring/phi/ list
+    G4int                   fRunID;
+    std::vector<G4double>   fPhiNorm;
+    std::vector<G4double>   fPhiWeights;
 };
 
 
@@ -0,0 +1,85 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file GCRSpectrum.hh
+/// \brief Definition of the GCRSpectrum class
+
+#ifndef GCRSpectrum_h
+#define GCRSpectrum_h 1
+
+#include "SpectrumSampler.hh"
+#include "globals.hh"
+
+class G4ParticleDefinition;
+
+// GCR differential flux in the force-field approximation, as in the
+// energy_spectrum/GCR_energyMacro_*.m scripts, in particles/(MeV m2 sr s)
+// for a kinetic energy in MeV. The sampling table is built on a log grid
+// the first time it is needed after a change of the parameters.
+
+class GCRSpectrum
+{
+  public:
+    GCRSpectrum();
+   ~GCRSpectrum();
+
+  public:
+    static G4double ProtonFlux(G4double ekin, G4double phi);
+    static G4double AlphaFlux (G4double ekin, G4double phi);
+
+    G4double Flux(G4double ekin) const {return Flux(ekin, fPhi);};
+    G4double Flux(G4double ekin, G4double phi) const;
+
+    void SetParticle(const G4String&);
+    void SetPhi(G4double);
+    void SetEnergyRange(G4double emin, G4double emax);
+    void SetNbPoints(G4int);
+
+    G4ParticleDefinition* GetParticle()  const {return fParticle;};
+    G4double              GetPhi()       const {return fPhi;};
+    G4double              GetEmin()      const {return fEmin;};
+    G4double              GetEmax()      const {return fEmax;};
+
+    G4double Sample();
+    G4double GetIntegralFlux();
+    G4double IntegralFlux(G4double phi) const;
+
+  private:
+    void BuildTable();
+
+    G4ParticleDefinition* fParticle;
+    G4bool                fIsAlpha;
+    G4double              fPhi;
+    G4double              fEmin;
+    G4double              fEmax;
+    G4int                 fNbPoints;
+
+    SpectrumSampler       fSampler;
+    G4bool                fTableIsValid;
+};
+
+
+#endif
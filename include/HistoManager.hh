@@ -35,16 +35,34 @@
 #include "g4root.hh"
 //#include "g4xml.hh"
 
+class NuclideScorer;
+class Run;
+
 
 class HistoManager
 {
   public:
-   HistoManager();
+   HistoManager(NuclideScorer*);
   ~HistoManager();
 
+  public:
+    static G4int BookHisto(G4int id, const G4String& title);
+    static void  SetBinContent(G4int id, G4int bin, G4int entries,
+                               G4double sumw, G4double sumw2);
+    void SetBinning();
+    void FillProfiles(const Run*);
+
+    // ntuple of the produced nuclides, depth in cm and energies in MeV
+    void         ActivateRecords(G4bool);
+    static void  FillRecord(G4int Z, G4int A, G4double depth, G4double energy,
+                            G4int parent, G4double primaryEnergy,
+                            G4double weight);
+
   private:
     void Book();
-    G4String fFileName;
+    static G4String UnitSymbol(G4double value, const G4String& category);
+    G4String       fFileName;
+    NuclideScorer* fScorer;
 };
 
 
@@ -0,0 +1,81 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ImportanceBiasing.hh
+/// \brief Definition of the ImportanceBiasing class
+
+#ifndef ImportanceBiasing_h
+#define ImportanceBiasing_h 1
+
+#include "globals.hh"
+#include <cmath>
+#include <vector>
+
+class BiasingMessenger;
+class G4ParticleDefinition;
+
+// Geometric importance of the concentric shells of DetectorConstruction:
+// each shell is fRatio times more important than the one above it, the
+// core as the last shell, the world as the first one. The SteppingAction
+// splits the biased particles entering a more important shell and plays
+// Russian roulette with the ones leaving it, with weights keeping the
+// production unbiased. Shared by all threads, configured from the master.
+
+class ImportanceBiasing
+{
+  public:
+    ImportanceBiasing();
+   ~ImportanceBiasing();
+
+  public:
+    void     SetRatio(G4double ratio) {fRatio = ratio;};
+    G4double GetRatio() const         {return fRatio;};
+    G4bool   IsActive() const         {return fRatio != 1.;};
+
+    void   SetParticles(const std::vector<G4String>& names);
+    G4bool IsBiased(const G4ParticleDefinition* particle) const
+    {
+      for (size_t i=0; i<fParticles.size(); i++)
+        if (fParticles[i] == particle) return true;
+      return false;
+    };
+
+    // importance of the volume of copy number postCopy
+    // relative to the one of copy number preCopy
+    G4double ImportanceRatio(G4int preCopy, G4int postCopy) const
+      {return std::pow(fRatio, Level(postCopy) - Level(preCopy));};
+
+  private:
+    static G4int Level(G4int copy) {return (copy > 0) ? copy - 1 : 0;};
+
+    G4double                                 fRatio;
+    std::vector<const G4ParticleDefinition*> fParticles;
+
+    BiasingMessenger*                        fBiasingMessenger;
+};
+
+
+#endif
@@ -0,0 +1,106 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file MixedSource.hh
+/// \brief Definition of the MixedSource class
+
+#ifndef MixedSource_h
+#define MixedSource_h 1
+
+#include "SpectrumSampler.hh"
+#include "globals.hh"
+#include <vector>
+
+class G4ParticleDefinition;
+class MixedSourceMessenger;
+
+// GCR primaries of several species in one run (/source/mode mixed): the
+// species of each event is chosen in proportion to its integral flux, and
+// its kinetic energy is sampled from its own table. Protons and alphas
+// have the force-field spectra of GCRSpectrum; a heavier ion (C, O, Fe...)
+// has the alpha spectrum per nucleon times its abundance ratio to helium
+// at the same kinetic energy per nucleon. The energy range is per nucleon.
+// Shared by all threads: configured from the master, whose RunAction
+// builds the tables before the event loop; the workers only sample.
+
+class MixedSource
+{
+  public:
+    MixedSource();
+   ~MixedSource();
+
+  public:
+    void AddSpecies(const G4String& name);          // proton or alpha
+    void AddIon(G4int Z, G4int A, G4double ratio);  // ratio to He per nucleon
+    void Clear();
+    void SetPhi(G4double phi);
+    void SetEnergyRange(G4double emin, G4double emax);
+    void SetNbPoints(G4int n);
+    void List();
+
+    // particle definitions and tables, on the master before the run
+    void BuildTables();
+
+    G4bool   IsEmpty()      const {return fSpecies.empty();};
+    G4int    GetNbSpecies() const {return fSpecies.size();};
+    const G4String& GetName(G4int i) const {return fSpecies[i].fName;};
+    G4ParticleDefinition* GetParticle(G4int i) const {return fSpecies[i].fParticle;};
+    G4double GetPhi()       const {return fPhi;};
+    // particles/(m2 sr s) of species i, and of all of them
+    G4double GetIntegralFlux(G4int i) const {return fSpecies[i].fIntegral;};
+    G4double GetIntegralFlux() const;
+
+    // species index of the event, and its kinetic energy
+    G4int    Sample(G4double& energy) const;
+    // species index of a primary, -1 if it is not in the mixture
+    G4int    GetSpecies(const G4ParticleDefinition*) const;
+
+  private:
+    struct Species {
+      G4String              fName;
+      G4int                 fZ;
+      G4int                 fA;
+      G4double              fRatio;
+      G4ParticleDefinition* fParticle;
+      SpectrumSampler       fSampler;
+      G4double              fIntegral;
+    };
+
+    G4double Flux(const Species&, G4double ekin) const;
+
+    std::vector<Species>  fSpecies;
+    std::vector<G4double> fCumulative;
+    G4double              fPhi;
+    G4double              fEmin;
+    G4double              fEmax;
+    G4int                 fNbPoints;
+    G4bool                fTablesAreValid;
+
+    MixedSourceMessenger* fMixedMessenger;
+};
+
+
+#endif
@@ -0,0 +1,152 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NuclideScorer.hh
+/// \brief Definition of the NuclideScorer class
+
+#ifndef NuclideScorer_h
+#define NuclideScorer_h 1
+
+#include "globals.hh"
+#include <vector>
+
+class ScoringMessenger;
+
+// List of the radionuclides to be scored, with a dense (Z,A) -> nuclide index
+// table so that the lookup done for every secondary track is constant time.
+// Each nuclide has a depth histogram and, for every modulation parameter
+// of the reweighting list, a histogram reweighted to that GCR spectrum;
+// each of them has an activity histogram (dpm/kg) filled at end of run.
+// A single instance is shared by all threads: it is filled by macro commands
+// in PreInit state and only read during the event loop.
+
+class NuclideScorer
+{
+  public:
+    NuclideScorer();
+   ~NuclideScorer();
+
+  public:
+    G4int AddNuclide(G4int Z, G4int A);
+    G4int AddPhi(G4double phi);
+    void  ListNuclides() const;
+
+    void     SetMaxDepth(G4double depth) {fMaxDepth = depth;};
+    G4double GetMaxDepth() const         {return fMaxDepth;};
+
+    // one ntuple row per scored nuclide, for offline rebinning
+    void     SetRecords(G4bool records)  {fRecords = records;};
+    G4bool   GetRecords() const          {return fRecords;};
+
+    // index of nuclide (Z,A), or -1 if it is not scored
+    inline G4int GetNuclide(G4int Z, G4int A) const
+    {
+      if (Z <= 0 || Z > kMaxZ || A <= 0 || A > kMaxA) return -1;
+      return fNuclideIndex[Z*(kMaxA+1) + A];
+    };
+
+    G4int           GetNbNuclides()       const {return fNuclides.size();};
+    G4int           GetZ(G4int i)         const {return fNuclides[i].fZ;};
+    G4int           GetA(G4int i)         const {return fNuclides[i].fA;};
+    const G4String& GetName(G4int i)      const {return fNuclides[i].fName;};
+
+    // histogram of nuclide i, reweighted to phi value iphi (-1: none)
+    G4int GetHistoId(G4int i, G4int iphi = -1) const
+      {return fNuclides[i].fHistoIds[iphi+1];};
+    G4int GetActivityHistoId(G4int i, G4int iphi = -1) const
+      {return fNuclides[i].fActivityIds[iphi+1];};
+
+    G4int           GetNbPhi()            const {return fPhiValues.size();};
+    G4double        GetPhi(G4int iphi)    const {return fPhiValues[iphi];};
+
+    // histograms in booking order: histogram id = index
+    G4int           GetNbHistos()         const {return fHistos.size();};
+    G4int           GetHistoNuclide(G4int id) const {return fHistos[id].fNuclide;};
+    G4int           GetHistoPhi(G4int id)     const {return fHistos[id].fPhi;};
+    G4bool          IsActivityHisto(G4int id) const {return fHistos[id].fActivity;};
+    G4String        GetHistoTitle(G4int id) const;
+
+    // activity normalization: exposure time (0: saturation), integral
+    // intensity of the primaries in particles/(m2 sr s) (0: from the GCR
+    // source) and geometry factor area*sr of the source (0: isotropic
+    // flux on the whole sphere, pi*4pi*R2)
+    void     SetExposureTime(G4double t)    {fExposureTime = t;};
+    void     SetIntensity(G4double j)       {fIntensity = j;};
+    void     SetGeometryFactor(G4double g)  {fGeometryFactor = g;};
+    G4double GetExposureTime()   const {return fExposureTime;};
+    G4double GetIntensity()      const {return fIntensity;};
+    G4double GetGeometryFactor() const {return fGeometryFactor;};
+
+    // response matrix: mono-energetic primaries on a log grid of nbPoints
+    // kinetic energies from emin to emax (/source/mode grid), with the
+    // depth profiles of every nuclide per grid point (0 points: none)
+    void     SetResponseGrid(G4double emin, G4double emax, G4int nbPoints);
+    G4int    GetNbResponsePoints() const {return fNbResponsePoints;};
+    G4double GetResponseEmin()     const {return fResponseEmin;};
+    G4double GetResponseEmax()     const {return fResponseEmax;};
+    G4double GetResponseEnergy(G4int point) const;
+    // grid point of a primary energy, -1 if it is not on the grid
+    G4int    GetResponsePoint(G4double energy) const;
+
+  private:
+    struct Nuclide {
+      G4int    fZ;
+      G4int    fA;
+      G4String fName;
+      std::vector<G4int> fHistoIds;
+      std::vector<G4int> fActivityIds;
+    };
+
+    struct Histo {
+      G4int    fNuclide;
+      G4int    fPhi;
+      G4bool   fActivity;
+    };
+
+    void AddHistos(G4int i, G4int iphi);
+
+    static const G4int kMaxZ = 120;
+    static const G4int kMaxA = 300;
+
+    std::vector<Nuclide>  fNuclides;
+    std::vector<G4int>    fNuclideIndex;
+    std::vector<G4double> fPhiValues;
+    std::vector<Histo>    fHistos;
+    G4double              fMaxDepth;
+    G4bool                fRecords;
+    G4bool                fWithActivity;
+    G4double              fExposureTime;
+    G4double              fIntensity;
+    G4double              fGeometryFactor;
+    G4double              fResponseEmin;
+    G4double              fResponseEmax;
+    G4int                 fNbResponsePoints;
+
+    ScoringMessenger*     fScoringMessenger;
+};
+
+
+#endif
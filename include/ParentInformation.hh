@@ -0,0 +1,59 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ParentInformation.hh
+/// \brief Definition of the ParentInformation class
+
+#ifndef ParentInformation_h
+#define ParentInformation_h 1
+
+#include "G4VUserTrackInformation.hh"
+#include "globals.hh"
+
+class G4ParticleDefinition;
+
+// Species and kinetic energy of the parent of a scored radionuclide,
+// attached by the SteppingAction to the new track when it is created,
+// read by the TrackingAction for the production-channel table.
+
+class ParentInformation : public G4VUserTrackInformation
+{
+  public:
+    ParentInformation(const G4ParticleDefinition* parent, G4double energy);
+    virtual ~ParentInformation();
+
+    virtual void Print() const;
+
+    const G4ParticleDefinition* GetParent() const {return fParent;};
+    G4double                    GetEnergy() const {return fEnergy;};
+
+  private:
+    const G4ParticleDefinition* fParent;
+    G4double                    fEnergy;
+};
+
+
+#endif
@@ -0,0 +1,82 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhysicsTableCache.hh
+/// \brief Definition of the PhysicsTableCache class
+
+#ifndef PhysicsTableCache_h
+#define PhysicsTableCache_h 1
+
+#include "G4VStateDependent.hh"
+#include "G4Timer.hh"
+#include "globals.hh"
+
+class G4VUserPhysicsList;
+class PhysicsTableCacheMessenger;
+
+// Follows the state changes of the master: /run/initialize (PreInit ->
+// Init -> Idle) and the physics tables built at the start of a run
+// (Idle -> Init -> Idle -> GeomClosed), timed once for the startup
+// report. The tables are rebuilt only when the materials or the cuts
+// change, which the key below follows. With a cache directory, the
+// tables are stored after a build in a subdirectory keyed by the physics
+// list, the materials and the production cuts, and retrieved from it by
+// the next jobs with the same key.
+
+class PhysicsTableCache : public G4VStateDependent
+{
+  public:
+    PhysicsTableCache(G4VUserPhysicsList*, const G4String& physicsListName);
+   ~PhysicsTableCache();
+
+  public:
+    virtual G4bool Notify(G4ApplicationState previous,
+                          G4ApplicationState requested);
+
+    void SetDirectory(const G4String& dir) {fDirectory = dir;};
+
+  private:
+    G4String ComputeKey() const;
+    void     PrintElements() const;
+
+    G4VUserPhysicsList*          fPhysicsList;
+    G4String                     fPhysicsListName;
+    G4String                     fDirectory;
+
+    G4bool                       fInitializing;
+    G4bool                       fBuilding;
+    G4bool                       fReported;
+    G4String                     fKey;
+    G4String                     fBuiltKey;
+    G4String                     fTableDir;
+    G4bool                       fRetrieving;
+    G4Timer                      fTimer;
+
+    PhysicsTableCacheMessenger*  fCacheMessenger;
+};
+
+
+#endif
@@ -64,20 +64,64 @@
 #include "globals.hh"
 
 class G4Event;
+class DetectorConstruction;
+class Profiler;
+class NuclideScorer;
+class SourceSpectrum;
+class MixedSource;
+class GCRSpectrum;
+class SCRSpectrum;
+class PrimaryGeneratorMessenger;
 
 
 class PrimaryGeneratorAction : public G4VUserPrimaryGeneratorAction
 {
   public:
-    PrimaryGeneratorAction();    
+    PrimaryGeneratorAction(DetectorConstruction*, NuclideScorer*,
+                           SourceSpectrum*, MixedSource*, Profiler*);    
    ~PrimaryGeneratorAction();
 
   public:
     virtual void              GeneratePrimaries(G4Event*);
     G4GeneralParticleSource*  GetParticleGun() {return fParticleGun;};
 
+    // "gps": energy and particle from the /gps/ commands
+    // "gcr": energy sampled from the analytic GCR spectrum
+    // "scr": energy sampled from the exponential-rigidity SCR spectrum
+    // "table": particle from the /gps/ commands, energy sampled from the
+    //          spectrum of /source/spectrum/load
+    // "mixed": GCR species and energy sampled from the /source/mixed/ list
+    // "grid": particle from the /gps/ commands, energies of the response
+    //         grid of the NuclideScorer in turn
+    void                      SetSourceMode(const G4String& mode);
+    const G4String&           GetSourceMode() const {return fSourceMode;};
+    GCRSpectrum*              GetGCRSpectrum()      {return fGCRSpectrum;};
+    SCRSpectrum*              GetSCRSpectrum()      {return fSCRSpectrum;};
+    SourceSpectrum*           GetSourceSpectrum()   {return fSpectrum;};
+    MixedSource*              GetMixedSource()      {return fMixed;};
+
+    // "gps"    : position and direction from the /gps/ commands
+    // "surface": isotropic flux on the target sphere, entry point uniform
+    //            on its surface and cosine-law inward direction
+    void                      SetPositionMode(const G4String& mode);
+    const G4String&           GetPositionMode() const {return fPositionMode;};
+    // "surface" mode, or forced by the DetectorConstruction during a sweep
+    G4bool                    IsSurfaceSource() const;
+
   private:
+    void                      SampleSurfaceVertex(G4Event*);
+
+    DetectorConstruction*     fDetector;
+    NuclideScorer*            fScorer;
+    SourceSpectrum*           fSpectrum;
+    MixedSource*              fMixed;
+    Profiler*                 fProfiler;
     G4GeneralParticleSource*  fParticleGun; //pointer a to G4 service class
+    G4String                  fSourceMode;
+    G4String                  fPositionMode;
+    GCRSpectrum*              fGCRSpectrum;
+    SCRSpectrum*              fSCRSpectrum;
+    PrimaryGeneratorMessenger* fPrimaryMessenger;
 };
 
 
@@ -0,0 +1,89 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ProductionFilter.hh
+/// \brief Definition of the ProductionFilter class
+
+#ifndef ProductionFilter_h
+#define ProductionFilter_h 1
+
+#include "globals.hh"
+#include <map>
+#include <vector>
+
+class FilterMessenger;
+class NuclideScorer;
+class G4ParticleDefinition;
+
+// Kinetic energy thresholds below which a new track cannot lead to any
+// of the scored radionuclides: the StackingAction kills it at birth.
+// The default thresholds of gamma, e- and e+ are the lowest separation
+// energy of a light particle (n, p, d, t, He3, alpha) from the target
+// isotopes heavier than a scored nuclide, or of any isotope of the
+// geometry when a scored nuclide is also made by neutron capture (then
+// the lowest (g,n) threshold, eg. 2.2 MeV on deuterium, applies);
+// neutrinos are always killed, neutrons never (thermal captures).
+// Per-species thresholds can be set by command. Shared by all threads,
+// computed by the master at the beginning of each run.
+
+class ProductionFilter
+{
+  public:
+    ProductionFilter();
+   ~ProductionFilter();
+
+  public:
+    void   SetActive(G4bool active) {fActive = active;};
+    G4bool IsActive() const         {return fActive;};
+    void   SetThreshold(const G4String& particle, G4double energy);
+
+    void   ComputeThresholds(const NuclideScorer*);
+    void   PrintThresholds() const;
+
+    inline G4bool IsIrrelevant(const G4ParticleDefinition*, G4double ekin) const;
+
+  private:
+    static G4double SeparationEnergy(G4int Z, G4int A);
+
+    G4bool                   fActive;
+    std::map<G4String,G4double> fUserThresholds;
+    std::vector<std::pair<const G4ParticleDefinition*,G4double> > fThresholds;
+
+    FilterMessenger*         fFilterMessenger;
+};
+
+
+inline G4bool ProductionFilter::IsIrrelevant(const G4ParticleDefinition* particle,
+                                             G4double ekin) const
+{
+  for (size_t i=0; i<fThresholds.size(); i++) {
+    if (fThresholds[i].first == particle) return ekin < fThresholds[i].second;
+  }
+  return false;
+}
+
+
+#endif
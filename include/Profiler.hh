@@ -0,0 +1,91 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Profiler.hh
+/// \brief Definition of the Profiler class
+
+#ifndef Profiler_h
+#define Profiler_h 1
+
+#include "globals.hh"
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+class ProfilerMessenger;
+
+// Built-in profiler: the user actions read a cheap tick counter (the TSC
+// on x86, a steady clock elsewhere) and the Run of each thread adds the
+// ticks of every step to its particle species, process and volume, and
+// the ticks of the primary generation. The master converts ticks to
+// seconds with the wall time of the run. Shared by all threads,
+// configured from the master.
+
+class Profiler
+{
+  public:
+    Profiler();
+   ~Profiler();
+
+  public:
+    void   SetActive(G4bool active)           {fActive = active;};
+    G4bool IsActive() const                   {return fActive;};
+    void   SetJsonFile(const G4String& name)  {fJsonFile = name;};
+    const G4String& GetJsonFile() const       {return fJsonFile;};
+
+    static inline std::uint64_t Ticks();
+
+    // calibration of the ticks on the master, over the whole run
+    void     BeginOfRun();
+    void     EndOfRun();
+    G4double GetSeconds(G4double ticks) const
+      {return (fTicksPerSecond > 0.) ? ticks/fTicksPerSecond : 0.;};
+
+  private:
+    G4bool                                fActive;
+    G4String                              fJsonFile;
+    std::uint64_t                         fStartTicks;
+    std::chrono::steady_clock::time_point fStartTime;
+    G4double                              fTicksPerSecond;
+
+    ProfilerMessenger*                    fProfilerMessenger;
+};
+
+
+inline std::uint64_t Profiler::Ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+}
+
+
+#endif
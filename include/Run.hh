@@ -32,51 +32,391 @@
 
 #include "G4Run.hh"
 #include "G4VProcess.hh"
+#include "G4Threading.hh"
+#include "G4SystemOfUnits.hh"
 #include "globals.hh"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
 #include <map>
+#include <vector>
+#include <cstdint>
 
 class DetectorConstruction;
+class NuclideScorer;
+class Profiler;
 class G4ParticleDefinition;
+class G4LogicalVolume;
+class G4Step;
 
 
 class Run : public G4Run
 {
   public:
-    Run(DetectorConstruction*);
+    Run(DetectorConstruction*, NuclideScorer*);
    ~Run();
 
   public:
     void SetPrimary(G4ParticleDefinition* particle, G4double energy);
-    void CountProcesses(const G4VProcess* process);
-    void ParticleCount(G4String, G4double);
+    // integral intensity of the source, then of each /scoring/phi/ value
+    void SetSourceIntensity(const std::vector<G4double>& intensity)
+      {fSourceIntensity = intensity;};
+    void SetSurfaceSource(G4bool surface) {fSurfaceSource = surface;};
+    void RegisterProcesses();
+    inline void CountProcesses(const G4VProcess* process);
+    inline void ParticleCount(const G4ParticleDefinition*, G4double);
+    inline void ShellCount(G4int nuclide, G4int shell, G4double weight = 1.);
+    void CountSplit(G4int nCopies) {fNbSplit += nCopies;};
+    void CountRoulette()           {fNbRoulette++;};
+    // production channel of a scored nuclide
+    inline void ChannelCount(const G4VProcess* creator,
+                             const G4ParticleDefinition* parent,
+                             G4int nuclide, G4double parentEnergy,
+                             G4double weight = 1.);
+    // tracks killed by the ProductionFilter
+    void KilledCount(const G4ParticleDefinition* particle)
+      {FindParticleData(particle).fKilled++;};
+    void CountEscaped()            {fNbEscaped++;};
+
+    // load balance: time spent in the events by each thread (s),
+    // and wall time of the run on the master
+    void AddBusyTime(G4double time)
+      { ThreadTime& t = fThreadTimes[G4Threading::G4GetThreadId()];
+        t.fEvents++; t.fBusy += time; };
+    void SetWallTime(G4double time) {fWallTime = time;};
+
+    // profiler: ticks of each step since the previous one of the track
+    void SetProfiler(const Profiler* profiler) {fProfiler = profiler;};
+    void ProfileTrack(std::uint64_t ticks)     {fLastTicks = ticks;};
+    void ProfileStep(const G4Step*, std::uint64_t ticks);
+    void ProfilePrimary(std::uint64_t ticks)   {fPrimaryTicks += ticks;};
+
+    // depth profiles of the scored radionuclides, with the binning of their
+    // histogram; bin 0 is the underflow, nbins+1 the overflow, -1 if the
+    // histogram is not active
+    inline G4int DepthBin(G4int nuclide, G4double depth) const;
+    inline void  FillDepth(G4int nuclide, G4int iphi, G4int bin,
+                           G4double weight = 1.);
+    G4int    GetNbDepthBins(G4int nuclide) const {return fProfiles[nuclide].fNbins;};
+    G4long   GetDepthEntries(G4int nuclide, G4int iphi, G4int bin) const
+               {return fProfileN[ProfileIndex(nuclide, iphi, bin)];};
+    G4double GetDepthSumW(G4int nuclide, G4int iphi, G4int bin) const
+               {return fProfileSw[ProfileIndex(nuclide, iphi, bin)];};
+    G4double GetDepthSumW2(G4int nuclide, G4int iphi, G4int bin) const
+               {return fProfileSw2[ProfileIndex(nuclide, iphi, bin)];};
+
+    // response matrix: primaries and depth profiles of the nuclides for
+    // each point of the energy grid of the NuclideScorer
+    void CountResponsePrimary(G4int point) {fResponseN[point]++;};
+    inline void FillResponse(G4int nuclide, G4int point, G4int bin,
+                             G4double weight = 1.);
+
+    // mixed source: primaries and depth profiles of the nuclides for
+    // each species of the primary
+    void SetSpecies(const std::vector<G4String>& names);
+    void CountSpeciesPrimary(G4int species) {fSpeciesN[species]++;};
+    inline void FillSpecies(G4int nuclide, G4int species, G4int bin,
+                            G4double weight = 1.);
 
     virtual void Merge(const G4Run*);
     void EndOfRun();     
+
+    // accumulated results of a checkpointed job, written with full
+    // precision; Load returns false if the file does not match the
+    // scored nuclides or the binning of this run
+    void   Save(std::ostream&) const;
+    G4bool Load(std::istream&);
    
   private:
     struct ParticleData {
      ParticleData()
-       : fCount(0), fEmean(0.), fEmin(0.), fEmax(0.) {}
-     ParticleData(G4int count, G4double ekin, G4double emin, G4double emax)
-       : fCount(count), fEmean(ekin), fEmin(emin), fEmax(emax) {}
-     G4int     fCount;
-     G4double  fEmean;
+       : fParticle(0), fCount(0), fKilled(0),
+         fEsum(0.), fEsum2(0.), fEmin(0.), fEmax(0.), fSteps(0), fTicks(0.) {}
+     const G4ParticleDefinition* fParticle;
+     G4long    fCount;
+     G4long    fKilled;
+     G4double  fEsum;
+     G4double  fEsum2;
      G4double  fEmin;
      G4double  fEmax;
+     G4long    fSteps;
+     G4double  fTicks;
+    };
+
+    struct ThreadTime {
+     ThreadTime() : fEvents(0), fBusy(0.) {}
+     G4long   fEvents;
+     G4double fBusy;
     };
+
+    static inline std::size_t PointerHash(const void*, G4int shift);
+    void PrintLoadBalance() const;
+    void PrintPerformance() const;
+    void PrintProfile() const;
+    void WriteProfileJson(const G4String& fileName) const;
+    static void WriteParticle(std::ostream&, const G4ParticleDefinition*);
+    static const G4ParticleDefinition* ReadParticle(std::istream&);
+    void WriteShells(const G4String& fileName) const;
+    void WriteChannels(const G4String& fileName) const;
+    void WriteResponse(const G4String& fileName) const;
+    void PrintSpecies() const;
+    void WriteSpecies(const G4String& fileName) const;
+    void ComputeActivities();
+    G4double ActivityNorm(G4int nuclide, G4int iphi) const;
+    G4double GeometryFactor() const;
+    void PrintFluxNormalization() const;
      
   private:
     DetectorConstruction* fDetector;
+    NuclideScorer*        fScorer;
     G4ParticleDefinition* fParticle;
     G4double              fEkin;
+    std::vector<G4double> fSourceIntensity;
+    G4bool                fSurfaceSource;
     
     G4double fEnergyDeposit, fEnergyDeposit2;
     G4double fEnergyFlow,    fEnergyFlow2;
     
-    std::map<G4String,G4int>        fProcCounter;
-    std::map<G4String,ParticleData> fParticleDataMap1;
-    std::map<G4String,ParticleData> fParticleDataMap2;
+    // processes are registered once per run with ids sorted by name,
+    // identical in all threads; a process pointer is mapped to its id
+    // with an open-addressing hash table
+    struct ProcessSlot {
+     const G4VProcess* fProcess;
+     G4int             fId;
+    };
+    inline G4int ProcessId(const G4VProcess*) const;
+
+    std::vector<ProcessSlot>        fProcSlots;
+    G4int                           fProcShift;
+    std::vector<const G4VProcess*>  fProcList;
+    std::vector<G4long>             fProcCounter;
+    std::map<G4String,G4long>       fOtherProcCounter;
+
+    // created particles, in an open-addressing hash table
+    // keyed by the (shared) particle definition
+    inline ParticleData& FindParticleData(const G4ParticleDefinition*);
+    void ResizeParticleTable(G4int nbits);
+
+    std::vector<ParticleData>       fParticleTable;
+    G4int                           fParticleShift;
+    G4int                           fNbParticles;
+
+    // radionuclides created in each shell (and the core):
+    // [nuclide*fNbLayers + shell]
+    G4int                           fNbLayers;
+    std::vector<G4double>           fShellSum;
+    std::vector<G4double>           fShellSum2;
+
+    // importance biasing: tracks added by splitting, killed by roulette
+    G4long                          fNbSplit;
+    G4long                          fNbRoulette;
+
+    // tracks leaving the meteorite, killed
+    G4long                          fNbEscaped;
+
+    std::map<G4int,ThreadTime>      fThreadTimes;
+    G4double                        fWallTime;
+
+    // profiler: ticks per process id (as fProcCounter), per volume
+    // and of the primary generation
+    struct VolumeCost {
+     VolumeCost() : fSteps(0), fTicks(0.) {}
+     G4long   fSteps;
+     G4double fTicks;
+    };
+    const Profiler*                 fProfiler;
+    std::uint64_t                   fLastTicks;
+    std::vector<G4double>           fProcTicks;
+    std::map<G4String,G4double>     fOtherProcTicks;
+    std::map<const G4LogicalVolume*,VolumeCost> fVolumeCosts;
+    G4double                        fPrimaryTicks;
+
+    // depth profiles: for each nuclide, nbins+2 bins for the histogram
+    // and for each of its reweighted histograms, in flat arrays
+    struct DepthAxis {
+      G4int    fNbins;
+      G4int    fOffset;
+      G4double fXmin;
+      G4double fInvWidth;
+      std::vector<G4double> fEdges;   // variable binning only
+    };
+    void BookProfiles();
+    G4int ProfileIndex(G4int nuclide, G4int iphi, G4int bin) const
+      {return fProfiles[nuclide].fOffset + (iphi+1)*(fProfiles[nuclide].fNbins+2) + bin;};
+
+    // production channels: creator process and parent species, each with
+    // a (nuclide x decade of the parent energy) table; a few tens of
+    // channels, searched linearly
+    struct Channel {
+      const G4VProcess*           fProcess;
+      G4String                    fProcessName;
+      const G4ParticleDefinition* fParent;
+      std::vector<G4double>       fSumW;
+      std::vector<G4double>       fSumW2;
+    };
+    Channel& AddChannel(const G4VProcess*, const G4String&,
+                        const G4ParticleDefinition*);
+
+    static const G4int kBandMin = -9;   // 1 meV
+    static const G4int kNbBands = 17;   // up to 1 TeV, with under/overflow
+    std::vector<Channel>            fChannels;
+
+    std::vector<DepthAxis>          fProfiles;
+    std::vector<G4long>             fProfileN;
+    std::vector<G4double>           fProfileSw;
+    std::vector<G4double>           fProfileSw2;
+
+    // one set of depth profiles, without the reweighted histograms:
+    // nuclide offsets and size, in bins
+    G4int                           fDepthSize;
+    std::vector<G4int>              fDepthOffsets;
+
+    // response matrix: [point*fDepthSize + fDepthOffsets[nuclide] + bin]
+    std::vector<G4long>             fResponseN;
+    std::vector<G4double>           fResponseSw;
+    std::vector<G4double>           fResponseSw2;
+
+    // mixed source, same layout per species
+    std::vector<G4String>           fSpeciesNames;
+    std::vector<G4long>             fSpeciesN;
+    std::vector<G4double>           fSpeciesSw;
+    std::vector<G4double>           fSpeciesSw2;
 };
 
 
+inline std::size_t Run::PointerHash(const void* ptr, G4int shift)
+{
+  // Fibonacci hashing: the top bits of the product are well mixed
+  std::uint64_t key = reinterpret_cast<std::uintptr_t>(ptr);
+  return (key * UINT64_C(0x9E3779B97F4A7C15)) >> shift;
+}
+
+
+inline G4int Run::ProcessId(const G4VProcess* process) const
+{
+  if (fProcSlots.empty()) return -1;
+  std::size_t mask = fProcSlots.size() - 1;
+  std::size_t h = PointerHash(process, fProcShift);
+  while (fProcSlots[h].fProcess) {
+    if (fProcSlots[h].fProcess == process) return fProcSlots[h].fId;
+    h = (h + 1) & mask;
+  }
+  return -1;
+}
+
+
+inline void Run::CountProcesses(const G4VProcess* process)
+{
+  G4int id = ProcessId(process);
+  if (id >= 0) fProcCounter[id]++;
+  else if (process) fOtherProcCounter[process->GetProcessName()]++;
+}
+
+
+inline Run::ParticleData& Run::FindParticleData(const G4ParticleDefinition* particle)
+{
+  std::size_t mask = fParticleTable.size() - 1;
+  std::size_t h = PointerHash(particle, fParticleShift);
+  while (fParticleTable[h].fParticle) {
+    if (fParticleTable[h].fParticle == particle) return fParticleTable[h];
+    h = (h + 1) & mask;
+  }
+
+  // new entry: keep the table at most half full
+  if (2*(fNbParticles + 1) > G4int(fParticleTable.size())) {
+    ResizeParticleTable(64 - fParticleShift + 1);
+    return FindParticleData(particle);
+  }
+  fNbParticles++;
+  fParticleTable[h].fParticle = particle;
+  return fParticleTable[h];
+}
+
+
+inline void Run::ParticleCount(const G4ParticleDefinition* particle, G4double Ekin)
+{
+  ParticleData& data = FindParticleData(particle);
+  if (data.fCount == 0) data.fEmin = data.fEmax = Ekin;
+  data.fCount++;
+  data.fEsum  += Ekin;
+  data.fEsum2 += Ekin*Ekin;
+  //update min max
+  if (Ekin < data.fEmin) data.fEmin = Ekin;
+  if (Ekin > data.fEmax) data.fEmax = Ekin;
+}
+
+
+inline void Run::ShellCount(G4int nuclide, G4int shell, G4double weight)
+{
+  std::size_t k = nuclide*fNbLayers + shell;
+  fShellSum[k]  += weight;
+  fShellSum2[k] += weight*weight;
+}
+
+
+inline G4int Run::DepthBin(G4int nuclide, G4double depth) const
+{
+  const DepthAxis& axis = fProfiles[nuclide];
+  if (axis.fNbins == 0) return -1;
+  if (axis.fEdges.empty()) {
+    G4double x = (depth - axis.fXmin)*axis.fInvWidth;
+    if (x < 0.) return 0;
+    if (x >= axis.fNbins) return axis.fNbins + 1;
+    return G4int(x) + 1;
+  }
+  return std::upper_bound(axis.fEdges.begin(), axis.fEdges.end(), depth)
+         - axis.fEdges.begin();
+}
+
+
+inline void Run::ChannelCount(const G4VProcess* creator,
+                              const G4ParticleDefinition* parent,
+                              G4int nuclide, G4double parentEnergy,
+                              G4double weight)
+{
+  Channel* channel = 0;
+  for (size_t i=0; i<fChannels.size() && !channel; i++) {
+    if (fChannels[i].fProcess == creator && fChannels[i].fParent == parent)
+      channel = &fChannels[i];
+  }
+  if (!channel) channel = &AddChannel(creator, creator->GetProcessName(), parent);
+
+  G4int band = 0;
+  if (parentEnergy > 0.) {
+    band = G4int(std::floor(std::log10(parentEnergy/CLHEP::MeV))) - kBandMin + 1;
+    band = std::min(std::max(band, 0), kNbBands - 1);
+  }
+  std::size_t k = nuclide*kNbBands + band;
+  channel->fSumW[k]  += weight;
+  channel->fSumW2[k] += weight*weight;
+}
+
+
+inline void Run::FillDepth(G4int nuclide, G4int iphi, G4int bin, G4double weight)
+{
+  G4int k = ProfileIndex(nuclide, iphi, bin);
+  fProfileN[k]++;
+  fProfileSw[k]  += weight;
+  fProfileSw2[k] += weight*weight;
+}
+
+
+inline void Run::FillResponse(G4int nuclide, G4int point, G4int bin,
+                              G4double weight)
+{
+  std::size_t k = point*fDepthSize + fDepthOffsets[nuclide] + bin;
+  fResponseSw[k]  += weight;
+  fResponseSw2[k] += weight*weight;
+}
+
+
+inline void Run::FillSpecies(G4int nuclide, G4int species, G4int bin,
+                             G4double weight)
+{
+  std::size_t k = species*fDepthSize + fDepthOffsets[nuclide] + bin;
+  fSpeciesSw[k]  += weight;
+  fSpeciesSw2[k] += weight*weight;
+}
+
+
 #endif
@@ -31,6 +31,7 @@
 #define RunAction_h 1
 
 #include "G4UserRunAction.hh"
+#include "G4Timer.hh"
 #include "globals.hh"
 
 
@@ -38,24 +39,39 @@ class DetectorConstruction;
 class Run;
 class PrimaryGeneratorAction;
 class HistoManager;
+class NuclideScorer;
+class ProductionFilter;
+class Checkpoint;
+class Profiler;
+class MixedSource;
 
 
 class RunAction : public G4UserRunAction
 {
   public:
-    RunAction(DetectorConstruction*, PrimaryGeneratorAction*);
+    RunAction(DetectorConstruction*, PrimaryGeneratorAction*, NuclideScorer*,
+              ProductionFilter*, Checkpoint*, Profiler*, MixedSource*);
    ~RunAction();
 
   public:
     virtual G4Run* GenerateRun();  
     virtual void BeginOfRunAction(const G4Run*);
     virtual void   EndOfRunAction(const G4Run*);
+
+    // histograms and text files of a Run not processed by this job
+    void WriteResults(Run*) const;
                             
   private:
     DetectorConstruction*      fDetector;
     PrimaryGeneratorAction*    fPrimary;
+    NuclideScorer*             fScorer;
+    ProductionFilter*          fFilter;
+    Checkpoint*                fCheckpoint;
+    Profiler*                  fProfiler;
+    MixedSource*               fMixed;
     Run*                       fRun;    
     HistoManager*              fHistoManager;
+    G4Timer                    fTimer;
         
 };
 
@@ -0,0 +1,80 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SCRSpectrum.hh
+/// \brief Definition of the SCRSpectrum class
+
+#ifndef SCRSpectrum_h
+#define SCRSpectrum_h 1
+
+#include "globals.hh"
+
+class G4ParticleDefinition;
+
+// Solar cosmic ray spectrum, exponential in rigidity: the integral flux
+// above the rigidity R is J(>R) = J0*exp(-R/R0), R0 the characteristic
+// rigidity. The normalization is given as the omnidirectional (4pi) flux
+// above a kinetic energy, the usual form of the SCR fluxes (e.g. above
+// 10 MeV, in particles/(cm2 s)); the isotropic intensity is this flux
+// over 4pi. The rigidity is sampled by inversion of the truncated
+// exponential between the rigidities of Emin and Emax, without table.
+
+class SCRSpectrum
+{
+  public:
+    SCRSpectrum();
+   ~SCRSpectrum();
+
+  public:
+    void SetParticle(const G4String&);
+    void SetR0(G4double r0)                 {fR0 = r0;};
+    void SetFlux(G4double flux)             {fFlux = flux;};
+    void SetFluxAbove(G4double ekin)        {fFluxAbove = ekin;};
+    void SetEnergyRange(G4double emin, G4double emax);
+
+    G4ParticleDefinition* GetParticle()  const {return fParticle;};
+    G4double              GetR0()        const {return fR0;};
+    G4double              GetEmin()      const {return fEmin;};
+    G4double              GetEmax()      const {return fEmax;};
+
+    G4double Rigidity(G4double ekin) const;
+    G4double KineticEnergy(G4double rigidity) const;
+
+    G4double Sample() const;
+    // particles/(m2 sr s) between Emin and Emax
+    G4double GetIntegralFlux() const;
+
+  private:
+    G4ParticleDefinition* fParticle;
+    G4double              fR0;
+    G4double              fFlux;
+    G4double              fFluxAbove;
+    G4double              fEmin;
+    G4double              fEmax;
+};
+
+
+#endif
@@ -0,0 +1,82 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ScoringMessenger.hh
+/// \brief Definition of the ScoringMessenger class
+
+#ifndef ScoringMessenger_h
+#define ScoringMessenger_h 1
+
+#include "G4UImessenger.hh"
+#include "globals.hh"
+
+class NuclideScorer;
+class G4UIdirectory;
+class G4UIcommand;
+class G4UIcmdWithADouble;
+class G4UIcmdWithADoubleAndUnit;
+class G4UIcmdWithoutParameter;
+class G4UIcmdWithABool;
+
+
+class ScoringMessenger: public G4UImessenger
+{
+  public:
+
+    ScoringMessenger(NuclideScorer* );
+   ~ScoringMessenger();
+
+    virtual void SetNewValue(G4UIcommand*, G4String);
+
+  private:
+
+    void BookNewHistos(G4int first);
+
+  private:
+
+    NuclideScorer*             fScorer;
+
+    G4UIdirectory*             fScoringDir;
+    G4UIdirectory*             fNuclideDir;
+    G4UIcommand*               fAddCmd;
+    G4UIcmdWithADoubleAndUnit* fMaxDepthCmd;
+    G4UIcmdWithoutParameter*   fListCmd;
+    G4UIcmdWithABool*          fRecordsCmd;
+
+    G4UIdirectory*             fPhiDir;
+    G4UIcmdWithADoubleAndUnit* fPhiCmd;
+
+    G4UIdirectory*             fActivityDir;
+    G4UIcmdWithADoubleAndUnit* fExposureCmd;
+    G4UIcmdWithADouble*        fIntensityCmd;
+    G4UIcmdWithADoubleAndUnit* fGeometryCmd;
+
+    G4UIdirectory*             fResponseDir;
+    G4UIcommand*               fGridCmd;
+};
+
+
+#endif
@@ -0,0 +1,63 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ShardRunManager.hh
+/// \brief Definition of the ShardRunManager class
+
+#ifndef ShardRunManager_h
+#define ShardRunManager_h 1
+
+#include "ActionInitialization.hh"
+#include "Checkpoint.hh"
+#include "globals.hh"
+
+// Run manager of the main program, of the type chosen at startup: the
+// /run/beamOn of a shard of a larger job (/checkpoint/shard) runs its
+// share of the events. The segments of /checkpoint/beamOn and
+// /run/beamUntil are shared out by the Checkpoint itself.
+
+template <class T>
+class ShardRunManager : public T
+{
+  public:
+    ShardRunManager() : T() {};
+    virtual ~ShardRunManager() {};
+
+  public:
+    virtual void BeamOn(G4int nbEvents, const char* macroFile = 0,
+                        G4int nSelect = -1)
+    {
+      const ActionInitialization* actions =
+        static_cast<const ActionInitialization*>(this->GetUserActionInitialization());
+      Checkpoint* checkpoint = actions ? actions->GetCheckpoint() : 0;
+      if (checkpoint && !checkpoint->IsActive())
+        nbEvents = checkpoint->StartShard(nbEvents);
+      T::BeamOn(nbEvents, macroFile, nSelect);
+    };
+};
+
+
+#endif
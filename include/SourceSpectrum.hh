@@ -0,0 +1,77 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SourceSpectrum.hh
+/// \brief Definition of the SourceSpectrum class
+
+#ifndef SourceSpectrum_h
+#define SourceSpectrum_h 1
+
+#include "SpectrumSampler.hh"
+#include "globals.hh"
+#include <iosfwd>
+#include <vector>
+
+class SourceSpectrumMessenger;
+
+// Tabulated energy spectrum of the primaries (/source/mode table), read
+// from a file instead of /gps/hist/point commands. The file is parsed once
+// on the master (/source/spectrum/load) and its sampling table built at
+// the same time; the workers only sample it. Text files have two columns,
+// kinetic energy and differential flux, separated by blanks or commas
+// ('#' starts a comment); binary files, written by /source/spectrum/save,
+// start with "RNSPEC01", then the number of points (int64), the energies
+// in MeV and the fluxes (float64, native byte order).
+
+class SourceSpectrum
+{
+  public:
+    SourceSpectrum();
+   ~SourceSpectrum();
+
+  public:
+    G4bool Load(const G4String& fileName, G4double energyUnit);
+    G4bool Save(const G4String& fileName) const;
+
+    G4bool   IsEmpty()  const {return fSampler.IsEmpty();};
+    G4double Sample()   const {return fSampler.Sample();};
+    G4double GetIntegral() const {return fSampler.GetIntegral();};
+    const G4String& GetFileName() const {return fFileName;};
+
+  private:
+    G4bool ReadBinary(std::istream&);
+    G4bool ReadText(std::istream&, G4double energyUnit);
+
+    G4String              fFileName;
+    std::vector<G4double> fEnergy;
+    std::vector<G4double> fFlux;
+    SpectrumSampler       fSampler;
+
+    SourceSpectrumMessenger* fSpectrumMessenger;
+};
+
+
+#endif
@@ -0,0 +1,72 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SpectrumSampler.hh
+/// \brief Definition of the SpectrumSampler class
+
+#ifndef SpectrumSampler_h
+#define SpectrumSampler_h 1
+
+#include "globals.hh"
+#include <vector>
+
+// Samples the kinetic energy from a tabulated differential spectrum.
+// Between two points the spectrum is interpolated as a power law (linearly
+// if one of the points is zero); the bin is chosen with Walker's alias
+// method, so sampling is O(1) whatever the number of points.
+
+class SpectrumSampler
+{
+  public:
+    SpectrumSampler();
+   ~SpectrumSampler();
+
+  public:
+    void SetTable(const std::vector<G4double>& energies,
+                  const std::vector<G4double>& flux);
+
+    G4double Sample() const;
+
+    // integral of the interpolated spectrum between two points
+    static G4double BinIntegral(G4double e0, G4double e1,
+                                G4double j0, G4double j1);
+
+    G4bool   IsEmpty()     const {return fProb.empty();};
+    G4double GetIntegral() const {return fIntegral;};
+    G4double GetEmin()     const {return fEnergy.front();};
+    G4double GetEmax()     const {return fEnergy.back();};
+
+  private:
+    std::vector<G4double> fEnergy;    // bin edges
+    std::vector<G4double> fFlux;      // spectrum at the bin edges
+    std::vector<G4double> fSlope;     // power law index in each bin
+    std::vector<G4double> fProb;      // alias table
+    std::vector<G4int>    fAlias;
+    G4double              fIntegral;  // integral of the spectrum
+};
+
+
+#endif
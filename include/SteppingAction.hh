@@ -34,18 +34,31 @@
 #include "globals.hh"
 
 class EventAction;
+class ImportanceBiasing;
+class ProductionFilter;
+class NuclideScorer;
+class Profiler;
+class Run;
 
 
 class SteppingAction : public G4UserSteppingAction
 {
   public:
-    SteppingAction(EventAction*);
+    SteppingAction(EventAction*, ImportanceBiasing*, ProductionFilter*,
+                   NuclideScorer*, Profiler*);
    ~SteppingAction();
 
     virtual void UserSteppingAction(const G4Step*);
     
   private:
-    EventAction*  fEventAction;    
+    void SplitOrKill(const G4Step*, Run*);
+    void TagNuclides(const G4Step*);
+
+    EventAction*        fEventAction;    
+    ImportanceBiasing*  fBiasing;
+    ProductionFilter*   fFilter;
+    NuclideScorer*      fScorer;
+    Profiler*           fProfiler;
 };
 
 
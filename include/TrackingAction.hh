@@ -33,19 +33,26 @@
 #include "G4UserTrackingAction.hh"
 #include "globals.hh"
 
+class DetectorConstruction;
 class EventAction;
+class NuclideScorer;
+class Profiler;
 
 
 class TrackingAction : public G4UserTrackingAction {
 
   public:  
-    TrackingAction(EventAction*);
+    TrackingAction(DetectorConstruction*, EventAction*, NuclideScorer*,
+                   Profiler*);
    ~TrackingAction() {};
    
     virtual void  PreUserTrackingAction(const G4Track*);
     
   private:
-    EventAction* fEventAction;
+    DetectorConstruction* fDetector;
+    EventAction*          fEventAction;
+    NuclideScorer*        fScorer;
+    Profiler*             fProfiler;
 };
 
 
@@ -34,41 +34,75 @@
 #include "TrackingAction.hh"
 #include "SteppingAction.hh"
 #include "SteppingVerbose.hh"
+#include "NuclideScorer.hh"
+#include "ImportanceBiasing.hh"
+#include "ProductionFilter.hh"
+#include "StackingAction.hh"
+#include "Checkpoint.hh"
+#include "Profiler.hh"
+#include "SourceSpectrum.hh"
+#include "MixedSource.hh"
 
 
 ActionInitialization::ActionInitialization(DetectorConstruction* detector)
  : G4VUserActionInitialization(),
-   fDetector(detector)
-{}
+   fDetector(detector), fScorer(0), fBiasing(0), fFilter(0),
+   fCheckpoint(0), fProfiler(0), fSpectrum(0), fMixed(0)
+{
+  // shared by all threads, configured from the master
+  fScorer  = new NuclideScorer();
+  fBiasing = new ImportanceBiasing();
+  fFilter  = new ProductionFilter();
+  fCheckpoint = new Checkpoint(detector, fScorer);
+  fProfiler   = new Profiler();
+  fSpectrum   = new SourceSpectrum();
+  fMixed      = new MixedSource();
+}
 
 
 ActionInitialization::~ActionInitialization()
-{}
+{
+  delete fCheckpoint;
+  delete fScorer;
+  delete fBiasing;
+  delete fFilter;
+  delete fProfiler;
+  delete fSpectrum;
+  delete fMixed;
+}
 
 
 void ActionInitialization::BuildForMaster() const
 {
-  RunAction* runAction = new RunAction(fDetector, 0);
+  RunAction* runAction = new RunAction(fDetector, 0, fScorer, fFilter,
+                                        fCheckpoint, fProfiler, fMixed);
   SetUserAction(runAction);
 }
 
 
 void ActionInitialization::Build() const
 {
-  PrimaryGeneratorAction* primary = new PrimaryGeneratorAction();
+  PrimaryGeneratorAction* primary =
+    new PrimaryGeneratorAction(fDetector, fScorer, fSpectrum, fMixed, fProfiler);
   SetUserAction(primary);
     
-  RunAction* runAction = new RunAction(fDetector, primary );
+  RunAction* runAction = new RunAction(fDetector, primary, fScorer, fFilter,
+                                        fCheckpoint, fProfiler, fMixed);
   SetUserAction(runAction);
   
-  EventAction* event = new EventAction();
+  EventAction* event = new EventAction(primary, fScorer, fCheckpoint);
   SetUserAction(event);  
   
-  TrackingAction* trackingAction = new TrackingAction(event);
+  TrackingAction* trackingAction = new TrackingAction(fDetector, event, fScorer,
+                                                     fProfiler);
   SetUserAction(trackingAction);
   
-  SteppingAction* steppingAction = new SteppingAction(event);
+  SteppingAction* steppingAction =
+    new SteppingAction(event, fBiasing, fFilter, fScorer, fProfiler);
   SetUserAction(steppingAction);
+
+  StackingAction* stackingAction = new StackingAction(fFilter);
+  SetUserAction(stackingAction);
 }  
 
 
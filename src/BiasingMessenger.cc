@@ -0,0 +1,84 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file BiasingMessenger.cc
+/// \brief Implementation of the BiasingMessenger class
+
+#include "BiasingMessenger.hh"
+#include "ImportanceBiasing.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithAString.hh"
+
+
+BiasingMessenger::BiasingMessenger(ImportanceBiasing* biasing)
+:G4UImessenger(),
+ fBiasing(biasing), fBiasDir(0), fRatioCmd(0), fParticlesCmd(0)
+{
+  G4bool broadcast = false;
+  fBiasDir = new G4UIdirectory("/testhadr/bias/", broadcast);
+  fBiasDir->SetGuidance("importance splitting on the concentric shells");
+
+  fRatioCmd = new G4UIcmdWithADouble("/testhadr/bias/importanceRatio", this);
+  fRatioCmd->SetGuidance("Importance of each shell relative to the one above it.");
+  fRatioCmd->SetGuidance("Particles going inwards are split, the ones going");
+  fRatioCmd->SetGuidance("outwards play Russian roulette (1: no biasing).");
+  fRatioCmd->SetGuidance("Needs the shells of /testhadr/det/setShells.");
+  fRatioCmd->SetParameterName("ratio", false);
+  fRatioCmd->SetRange("ratio > 0.");
+  fRatioCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fParticlesCmd = new G4UIcmdWithAString("/testhadr/bias/particles", this);
+  fParticlesCmd->SetGuidance("List of the biased particles");
+  fParticlesCmd->SetGuidance("  e.g. /testhadr/bias/particles neutron proton");
+  fParticlesCmd->SetParameterName("particles", false);
+  fParticlesCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+
+BiasingMessenger::~BiasingMessenger()
+{
+  delete fRatioCmd;
+  delete fParticlesCmd;
+  delete fBiasDir;
+}
+
+
+void BiasingMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fRatioCmd)
+   { fBiasing->SetRatio(fRatioCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fParticlesCmd)
+   {
+     std::vector<G4String> names;
+     G4String name;
+     std::istringstream is(newValue);
+     while (is >> name) names.push_back(name);
+     fBiasing->SetParticles(names);
+   }
+}
@@ -0,0 +1,598 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Checkpoint.cc
+/// \brief Implementation of the Checkpoint class
+
+#include "Checkpoint.hh"
+#include "CheckpointMessenger.hh"
+#include "Run.hh"
+#include "RunAction.hh"
+#include "HistoManager.hh"
+#include "NuclideScorer.hh"
+
+#include "G4RunManager.hh"
+#include "G4AutoLock.hh"
+#include "G4Threading.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
+namespace { G4Mutex snapshotMutex = G4MUTEX_INITIALIZER; }
+
+
+Checkpoint::Checkpoint(DetectorConstruction* det, NuclideScorer* scorer)
+: fDetector(det), fScorer(scorer), fFileName("RadionuclidesProduction.chk"),
+  fEveryEvents(0), fEveryTime(0.), fActive(false), fNbEvents(0), fNbDone(0),
+  fSegment(0), fTotal(0), fTargetIndex(-1), fJobTime(0.), fEventTime(0.),
+  fMinSegmentTime(10*minute), fSnapshotEvents(10), fStop(false),
+  fShard(-1), fNbShards(0), fJobEvents(0), fShardSeeded(false),
+  fCheckpointMessenger(0)
+{
+  fCheckpointMessenger = new CheckpointMessenger(this);
+}
+
+
+Checkpoint::~Checkpoint()
+{
+  delete fTotal;
+  delete fCheckpointMessenger;
+}
+
+
+void Checkpoint::BeamOn(G4int nbEvents)
+{
+  delete fTotal;
+  fTotal    = 0;
+  fNbEvents = StartShard(nbEvents);
+  fNbDone   = 0;
+  fTarget   = Target();
+  RunSegments();
+}
+
+
+void Checkpoint::BeamUntil(G4double precision, const G4String& nuclide,
+                           G4int firstBin, G4int lastBin, G4double maxTime,
+                           G4int maxEvents)
+{
+  Target target;
+  target.fPrecision = precision;
+  target.fNuclide   = nuclide;
+  target.fFirstBin  = std::min(firstBin, lastBin);
+  target.fLastBin   = std::max(firstBin, lastBin);
+  target.fMaxTime   = maxTime;
+
+  delete fTotal;
+  fTotal    = 0;
+  fNbEvents = std::numeric_limits<G4int>::max();
+  if (maxEvents > 0) fNbEvents = StartShard(maxEvents);
+  else if (IsShard()) {
+    fJobEvents = 0;
+    SeedShard();
+  }
+  fNbDone   = 0;
+  fTarget   = target;
+  RunSegments();
+}
+
+
+void Checkpoint::Restart(const G4String& fileName)
+{
+  G4String name = (fileName == "") ? fFileName : fileName;
+  std::ifstream file(name);
+  G4int shard, nbShards, jobEvents;
+  if (!ReadHeader(file, fNbDone, fNbEvents, shard, nbShards, jobEvents, fTarget)) {
+    G4cout << "\n--> warning from Checkpoint::Restart : cannot read "
+           << name << G4endl;
+    fTarget = Target();
+    return;
+  }
+
+  // same geometry, scored nuclides and binning as the interrupted job
+  delete fTotal;
+  fTotal = new Run(fDetector, fScorer);
+  if (!fTotal->Load(file)) {
+    G4cout << "\n--> warning from Checkpoint::Restart : " << name
+           << " does not match the scoring of this job" << G4endl;
+    delete fTotal;
+    fTotal  = 0;
+    fTarget = Target();
+    return;
+  }
+  // the engine status already follows the seeds of the shard
+  G4Random::restoreEngineStatus((name + ".rndm").c_str());
+  fFileName = name;
+  if (IsShard()) {
+    fShardSeeded = true;
+    if (shard == fShard) fJobEvents = jobEvents;
+  }
+
+  if (IsAdaptive())
+    G4cout << "\n Restart from " << name << " : " << fNbDone
+           << " events done" << G4endl;
+  else
+    G4cout << "\n Restart from " << name << " : " << fNbDone << " of "
+           << fNbEvents << " events done" << G4endl;
+  RunSegments();
+}
+
+
+void Checkpoint::RunSegments()
+{
+  G4RunManager* runManager = G4RunManager::GetRunManager();
+  fOutputName = G4AnalysisManager::Instance()->GetFileName();
+
+  // nuclide of the precision target, and its histogram bins
+  fTargetIndex = -1;
+  if (IsAdaptive()) {
+    for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+      if (fScorer->GetName(i) == fTarget.fNuclide) fTargetIndex = i;
+    }
+    tools::histo::h1d* h1 = (fTargetIndex < 0) ? 0 :
+      G4AnalysisManager::Instance()->GetH1(fScorer->GetHistoId(fTargetIndex), false);
+    if (!h1) {
+      G4cout << "\n--> warning from Checkpoint::RunSegments : "
+             << fTarget.fNuclide << " is not a scored nuclide with an active"
+             << " histogram; job not started" << G4endl;
+      fTarget = Target();
+      return;
+    }
+    G4int nbins = h1->axis().bins();
+    if (fTarget.fLastBin >= nbins) {
+      G4cout << "\n--> warning from Checkpoint::RunSegments : the histogram of "
+             << fTarget.fNuclide << " has " << nbins << " bins; last bin "
+             << fTarget.fLastBin << " replaced by " << nbins - 1 << G4endl;
+      fTarget.fLastBin  = nbins - 1;
+      fTarget.fFirstBin = std::min(fTarget.fFirstBin, fTarget.fLastBin);
+    }
+  }
+
+  fActive    = true;
+  fJobTime   = 0.;
+  fEventTime = 0.;
+  fTimer.Start();
+  fJobTimer.Start();
+  while (fNbDone < fNbEvents) {
+    G4int done = fNbDone;
+    fSegment = fNbEvents - fNbDone;
+    if (IsAdaptive()) fSegment = std::min(NextSegment(), fSegment);
+    else if (fEveryEvents > 0) fSegment = std::min(fEveryEvents, fSegment);
+    else if (fEveryTime > 0.) fSegment = std::min(TimedSegment(fEveryTime), fSegment);
+    if (fSegment <= 0) break;
+    if (IsAdaptive()) StartSegment();
+    runManager->BeamOn(fSegment);
+    if (fNbDone == done) {
+      G4cout << "\n--> warning from Checkpoint::RunSegments : "
+             << "no event processed, job stopped" << G4endl;
+      break;
+    }
+  }
+
+  // the results of an adaptive job are the ones of the sum, written
+  // once it is known to be the last
+  if (IsAdaptive() && fTotal) {
+    if (fNbDone >= fNbEvents)
+      G4cout << "\n Precision target not reached: event limit of "
+             << fNbEvents << " events" << G4endl;
+    fNbEvents = fNbDone;
+    G4AnalysisManager::Instance()->SetFileName(fOutputName);
+    const RunAction* runAction =
+      static_cast<const RunAction*>(runManager->GetUserRunAction());
+    runAction->WriteResults(fTotal);
+    if (IsShard()) WriteShard(fTotal);
+  }
+
+  fActive  = false;
+  fSegment = 0;
+  fTarget  = Target();
+  fStop    = false;
+  delete fTotal;
+  fTotal = 0;
+}
+
+
+G4int Checkpoint::NextSegment()
+{
+  // first segment: /checkpoint/everyEvents, or a short one to measure
+  // the time per event
+  G4int first = (fEveryEvents > 0) ? fEveryEvents : TimedSegment(fMinSegmentTime);
+  if (!fTotal || fNbDone == 0) return first;
+
+  std::vector<G4double> sums;
+  TargetSums(fTotal, sums);
+  G4int bin;
+  G4double error = LargestError(sums, bin);
+  G4cout << "\n Precision : " << fNbDone << " events, largest relative error of "
+         << fTarget.fNuclide << " bins " << fTarget.fFirstBin << "-"
+         << fTarget.fLastBin << " : ";
+  if (error < DBL_MAX) G4cout << 100.*error << " % (bin " << bin << ")";
+  else                 G4cout << "bin " << bin << " empty";
+  G4cout << ", target " << 100.*fTarget.fPrecision << " %" << G4endl;
+
+  if (error <= fTarget.fPrecision) {
+    G4cout << "\n Precision target reached after " << fNbDone << " events, "
+           << G4BestUnit(fJobTime, "Time") << G4endl;
+    return 0;
+  }
+  G4double timeLeft = fTarget.fMaxTime - fJobTime;
+  if (fTarget.fMaxTime > 0. && timeLeft <= 0.) {
+    G4cout << "\n Precision target not reached: time budget of "
+           << G4BestUnit(fTarget.fMaxTime, "Time") << " spent" << G4endl;
+    return 0;
+  }
+
+  // the error goes as 1/sqrt(N): the events still needed (as many as
+  // done with an empty bin). The threads end the segment by themselves
+  // when the target is reached, so it is not shorter than
+  // /checkpoint/minSegmentTime, which bounds the number of segments, and
+  // not longer than /checkpoint/everyTime, for the checkpoints
+  G4double segment = fEveryEvents;
+  if (fEveryEvents <= 0) {
+    G4double needed = fNbDone;
+    if (error < DBL_MAX)
+      needed = fNbDone*((error/fTarget.fPrecision)*(error/fTarget.fPrecision) - 1.);
+    segment = std::max(needed, 0.1*fNbDone);
+    segment = std::max(segment, G4double(TimedSegment(fMinSegmentTime)));
+    if (fEveryTime > 0.)
+      segment = std::min(segment, G4double(TimedSegment(fEveryTime)));
+  }
+  // to end within the time budget; the time per event is not known yet
+  // after a restart
+  if (fTarget.fMaxTime > 0. && fEventTime <= 0.)
+    segment = std::min(segment, G4double(first));
+  if (fTarget.fMaxTime > 0. && fEventTime > 0.) {
+    segment = std::min(segment, timeLeft/fEventTime);
+    if (segment < 1.) {
+      G4cout << "\n Precision target not reached: time budget of "
+             << G4BestUnit(fTarget.fMaxTime, "Time") << " spent" << G4endl;
+      return 0;
+    }
+  }
+  return std::max(G4int(std::min(segment, 1.e9)), 1);
+}
+
+
+void Checkpoint::StartSegment()
+{
+  // sums of the previous segments; the threads add theirs
+  TargetSums(fTotal, fBaseSums);
+  fSnapshots.clear();
+  fStop = false;
+  fSegmentStart = std::chrono::steady_clock::now();
+}
+
+
+void Checkpoint::Snapshot(const Run* run)
+{
+  std::vector<G4double> sums;
+  TargetSums(run, sums);
+
+  // last snapshot of every thread, with the previous segments
+  G4AutoLock lock(&snapshotMutex);
+  fSnapshots[G4Threading::G4GetThreadId()] = sums;
+  std::vector<G4double> total(fBaseSums);
+  std::map<G4int, std::vector<G4double> >::const_iterator it;
+  for (it = fSnapshots.begin(); it != fSnapshots.end(); it++) {
+    for (size_t k=0; k<total.size(); k++) total[k] += it->second[k];
+  }
+  G4int bin;
+  if (LargestError(total, bin) <= fTarget.fPrecision) fStop = true;
+
+  if (fTarget.fMaxTime > 0.) {
+    std::chrono::duration<G4double> time =
+      std::chrono::steady_clock::now() - fSegmentStart;
+    if (fJobTime + time.count()*s >= fTarget.fMaxTime) fStop = true;
+  }
+}
+
+
+G4int Checkpoint::TimedSegment(G4double period) const
+{
+  // the events of the period at the time per event of the previous
+  // segment; a first short segment, a few events per thread, measures it
+  if (fEventTime <= 0.)
+    return 10*G4RunManager::GetRunManager()->GetNumberOfThreads();
+  return std::max(G4int(std::min(period/fEventTime, 1.e9)), 1);
+}
+
+
+void Checkpoint::TargetSums(const Run* run, std::vector<G4double>& sums) const
+{
+  // bin 0 of the Run is the underflow
+  G4int nbins = fTarget.fLastBin - fTarget.fFirstBin + 1;
+  sums.assign(2*nbins, 0.);
+  if (!run) return;
+  for (G4int k=0; k<nbins; k++) {
+    G4int bin = fTarget.fFirstBin + k;
+    if (bin >= run->GetNbDepthBins(fTargetIndex)) break;
+    sums[2*k]   = run->GetDepthSumW(fTargetIndex, -1, bin + 1);
+    sums[2*k+1] = run->GetDepthSumW2(fTargetIndex, -1, bin + 1);
+  }
+}
+
+
+G4double Checkpoint::LargestError(const std::vector<G4double>& sums,
+                                  G4int& worstBin) const
+{
+  // relative error of the nuclide counts in each bin; infinite in an
+  // empty bin
+  G4double largest = 0.;
+  worstBin = fTarget.fFirstBin;
+  for (size_t k=0; 2*k<sums.size(); k++) {
+    G4double sw = sums[2*k], sw2 = sums[2*k+1];
+    G4double error = (sw > 0.) ? std::sqrt(sw2)/sw : DBL_MAX;
+    if (error > largest) {
+      largest  = error;
+      worstBin = fTarget.fFirstBin + k;
+    }
+  }
+  return largest;
+}
+
+
+G4String Checkpoint::GetOutputFileName() const
+{
+  // the histograms go in the usual file at the last segment; the
+  // records of the others in a file per segment, named by its first event
+  if (!fActive) return "";
+  if (IsLastSegment()) return fOutputName;
+  return fOutputName + "_" + std::to_string(fNbDone);
+}
+
+
+Run* Checkpoint::EndOfSegment(const Run* run)
+{
+  if (!fTotal) fTotal = new Run(fDetector, fScorer);
+  fTotal->Merge(run);
+  fNbDone += run->GetNumberOfEvent();
+
+  // duration of the job, and time per event for the next segment
+  fJobTimer.Stop();
+  G4double time = fJobTimer.GetRealElapsed()*s;
+  fJobTime += time;
+  if (run->GetNumberOfEvent() > 0) fEventTime = time/run->GetNumberOfEvent();
+  fJobTimer.Start();
+
+  if (fNbDone >= fNbEvents && !IsAdaptive()) return fTotal;
+
+  // with a time interval, only the first segment after it is written;
+  // segments sized from the time interval are all written
+  fTimer.Stop();
+  G4bool timed = (fEveryTime > 0. && fEveryEvents <= 0 && !IsAdaptive());
+  if (fEveryTime <= 0. || timed || fTimer.GetRealElapsed()*s >= fEveryTime) {
+    Write();
+    fTimer.Start();
+  }
+  else if (IsAdaptive())
+    G4cout << "\n Segment done : " << fNbDone << " events" << G4endl;
+  else G4cout << "\n Segment done : " << fNbDone << " of " << fNbEvents
+              << " events" << G4endl;
+  return 0;
+}
+
+
+void Checkpoint::Write()
+{
+  // a complete file replaces the previous checkpoint
+  G4String tmpName = fFileName + ".tmp";
+  WriteFile(tmpName, fTotal, fNbDone, std::max(fNbEvents, fNbDone));
+  G4String rndmName = fFileName + ".rndm";
+  G4Random::saveEngineStatus((rndmName + ".tmp").c_str());
+  std::rename((rndmName + ".tmp").c_str(), rndmName.c_str());
+  std::rename(tmpName.c_str(), fFileName.c_str());
+
+  if (IsAdaptive())
+    G4cout << "\n Checkpoint " << fFileName << " : " << fNbDone
+           << " events" << G4endl;
+  else
+    G4cout << "\n Checkpoint " << fFileName << " : " << fNbDone << " of "
+           << fNbEvents << " events" << G4endl;
+}
+
+
+void Checkpoint::WriteFile(const G4String& fileName, const Run* run,
+                           G4int nbDone, G4int nbEvents) const
+{
+  // with the precision target and the time budget left of an adaptive job
+  G4double timeLeft = 0.;
+  if (fTarget.fMaxTime > 0.) timeLeft = std::max(fTarget.fMaxTime - fJobTime, 1.*s);
+  std::ofstream file(fileName);
+  file.precision(17);
+  file << "checkpoint " << nbDone << " " << nbEvents
+       << " shard " << fShard << " " << fNbShards << " " << fJobEvents
+       << " until " << fTarget.fPrecision << " " << fTarget.fNuclide << " "
+       << fTarget.fFirstBin << " " << fTarget.fLastBin << " " << timeLeft/s << "\n";
+  run->Save(file);
+  file.close();
+  if (!file) {
+    G4cout << "\n--> warning from Checkpoint::WriteFile : cannot write "
+           << fileName << G4endl;
+  }
+}
+
+
+std::istream& Checkpoint::ReadHeader(std::istream& in, G4int& nbDone,
+                                     G4int& nbEvents, G4int& shard,
+                                     G4int& nbShards, G4int& jobEvents,
+                                     Target& target)
+{
+  G4String key, shardKey, untilKey;
+  in >> key >> nbDone >> nbEvents >> shardKey >> shard >> nbShards >> jobEvents
+     >> untilKey >> target.fPrecision >> target.fNuclide
+     >> target.fFirstBin >> target.fLastBin >> target.fMaxTime;
+  target.fMaxTime *= s;
+  if (key != "checkpoint" || shardKey != "shard" || untilKey != "until")
+    in.setstate(std::ios::failbit);
+  return in;
+}
+
+
+void Checkpoint::SetShard(G4int index, G4int nbShards)
+{
+  if (index < 0 || index >= nbShards) {
+    G4cout << "\n--> warning from Checkpoint::SetShard : shard " << index
+           << " of " << nbShards << " ignored" << G4endl;
+    return;
+  }
+  fShard       = index;
+  fNbShards    = nbShards;
+  fShardSeeded = false;
+  G4cout << "\n Shard " << fShard << " of " << fNbShards
+         << " : seeds derived at the first run" << G4endl;
+}
+
+
+G4int Checkpoint::StartShard(G4int nbEvents)
+{
+  if (!IsShard()) return nbEvents;
+  if (nbEvents > 0) SeedShard();
+  fJobEvents = nbEvents;
+  G4int share = ShardShare(nbEvents);
+  G4cout << "\n Shard " << fShard << " of " << fNbShards << " : " << share
+         << " of " << nbEvents << " events" << G4endl;
+  return share;
+}
+
+
+G4int Checkpoint::ShardShare(G4int nbEvents) const
+{
+  // the first nbEvents % nbShards shards take one more event
+  return nbEvents/fNbShards + ((fShard < nbEvents % fNbShards) ? 1 : 0);
+}
+
+
+void Checkpoint::SeedShard()
+{
+  if (fShardSeeded) return;
+
+  // independent seeds for each shard: splitmix64 of the current seeds of
+  // the engine and of the index, kept in the range of the RanecuEngine
+  // seeds. The same macro and index give the same shard
+  const long* current = G4Random::getTheSeeds();
+  std::uint64_t z = (std::uint64_t(current[0]) << 32) ^ std::uint64_t(current[1]);
+  z += UINT64_C(0x9E3779B97F4A7C15)*(fShard + 1);
+  z = (z ^ (z >> 30))*UINT64_C(0xBF58476D1CE4E5B9);
+  z = (z ^ (z >> 27))*UINT64_C(0x94D049BB133111EB);
+  z = z ^ (z >> 31);
+  long seeds[3];
+  seeds[0] = long(z & 0x7FFFFFFF) | 1;
+  seeds[1] = long((z >> 32) & 0x7FFFFFFF) | 1;
+  seeds[2] = 0;
+  G4Random::setTheSeeds(seeds);
+  fShardSeeded = true;
+
+  G4cout << "\n Shard " << fShard << " of " << fNbShards << " : seeds "
+         << seeds[0] << " " << seeds[1] << G4endl;
+}
+
+
+void Checkpoint::WriteShard(const Run* run)
+{
+  // next to the output file of the shard
+  G4String fileName = G4AnalysisManager::Instance()->GetFileName();
+  if (fileName == "") fileName = "RadionuclidesProduction";
+  fileName += ".shard" + std::to_string(fShard);
+  G4int nbDone = run->GetNumberOfEvent();
+  G4int nbEvents = fActive ? fNbEvents : ShardShare(fJobEvents);
+  WriteFile(fileName, run, nbDone, std::max(nbEvents, nbDone));
+  G4cout << "\n Shard " << fShard << " of " << fNbShards
+         << " written in " << fileName << G4endl;
+}
+
+
+void Checkpoint::Merge(const std::vector<G4String>& fileNames)
+{
+  // sums of weights and of squared weights are added, so that the errors
+  // of the merged results are the ones of a single job
+  Run* total = new Run(fDetector, fScorer);
+  std::vector<G4bool> found;
+  G4int nbMerged = 0;
+  G4int jobEvents = -1, shardEvents = 0;
+  for (size_t i=0; i<fileNames.size(); i++) {
+    std::ifstream file(fileNames[i]);
+    G4int nbDone, nbEvents, shard, nbShards, fileJobEvents;
+    Target target;
+    Run part(fDetector, fScorer);
+    if (!ReadHeader(file, nbDone, nbEvents, shard, nbShards, fileJobEvents, target)
+        || !part.Load(file)) {
+      G4cout << "\n--> warning from Checkpoint::Merge : " << fileNames[i]
+             << " not read, or not matching the scoring of this job" << G4endl;
+      continue;
+    }
+    if (nbDone < nbEvents) {
+      G4cout << "\n--> warning from Checkpoint::Merge : " << fileNames[i]
+             << " is an unfinished job (" << nbDone << " of " << nbEvents
+             << " events)" << G4endl;
+    }
+    if (shard >= 0) {
+      G4int size = std::max(nbShards, shard + 1);
+      if (G4int(found.size()) < size) found.resize(size, false);
+      if (found[shard]) {
+        G4cout << "\n--> warning from Checkpoint::Merge : shard " << shard
+               << " given twice, " << fileNames[i] << " skipped" << G4endl;
+        continue;
+      }
+      found[shard] = true;
+      if (jobEvents >= 0 && fileJobEvents != jobEvents) {
+        G4cout << "\n--> warning from Checkpoint::Merge : " << fileNames[i]
+               << " is a shard of a job of " << fileJobEvents << " events, not "
+               << jobEvents << G4endl;
+      }
+      if (jobEvents < 0) jobEvents = fileJobEvents;
+      shardEvents += nbDone;
+    }
+    total->Merge(&part);
+    nbMerged++;
+  }
+  G4bool complete = true;
+  for (size_t k=0; k<found.size(); k++) {
+    if (!found[k]) G4cout << "\n--> warning from Checkpoint::Merge : shard "
+                          << k << " missing" << G4endl;
+    complete = complete && found[k];
+  }
+  // an adaptive job has no fixed number of events (0)
+  if (complete && jobEvents > 0 && shardEvents != jobEvents) {
+    G4cout << "\n--> warning from Checkpoint::Merge : the shards have "
+           << shardEvents << " events, the job " << jobEvents << G4endl;
+  }
+
+  G4cout << "\n Merged " << nbMerged << " files : "
+         << total->GetNumberOfEvent() << " events" << G4endl;
+  if (total->GetNumberOfEvent() > 0) {
+    const RunAction* runAction = static_cast<const RunAction*>(
+      G4RunManager::GetRunManager()->GetUserRunAction());
+    runAction->WriteResults(total);
+  }
+  delete total;
+}
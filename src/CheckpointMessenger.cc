@@ -0,0 +1,237 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CheckpointMessenger.cc
+/// \brief Implementation of the CheckpointMessenger class
+
+#include "CheckpointMessenger.hh"
+#include "Checkpoint.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+
+
+CheckpointMessenger::CheckpointMessenger(Checkpoint* checkpoint)
+:G4UImessenger(),
+ fCheckpoint(checkpoint), fCheckpointDir(0), fFileCmd(0), fEveryEventsCmd(0),
+ fEveryTimeCmd(0), fBeamOnCmd(0), fRestartCmd(0),
+ fShardCmd(0), fMergeCmd(0), fBeamUntilCmd(0), fMinSegmentTimeCmd(0),
+ fSnapshotEventsCmd(0)
+{
+  // not broadcast: the segments are run by the master
+  G4bool broadcast = false;
+  fCheckpointDir = new G4UIdirectory("/checkpoint/", broadcast);
+  fCheckpointDir->SetGuidance("long runs in segments, with checkpoint and restart");
+
+  fFileCmd = new G4UIcmdWithAString("/checkpoint/file", this);
+  fFileCmd->SetGuidance("Name of the checkpoint file");
+  fFileCmd->SetGuidance("  (default RadionuclidesProduction.chk; the random");
+  fFileCmd->SetGuidance("  engine status is in the same name + .rndm)");
+  fFileCmd->SetParameterName("fileName", false);
+  fFileCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fEveryEventsCmd = new G4UIcmdWithAnInteger("/checkpoint/everyEvents", this);
+  fEveryEventsCmd->SetGuidance("Number of events of a segment (0: a single segment)");
+  fEveryEventsCmd->SetParameterName("nbEvents", false);
+  fEveryEventsCmd->SetRange("nbEvents >= 0");
+  fEveryEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fEveryTimeCmd = new G4UIcmdWithADoubleAndUnit("/checkpoint/everyTime", this);
+  fEveryTimeCmd->SetGuidance("Time between two checkpoints (0: after every segment,");
+  fEveryTimeCmd->SetGuidance("the default). Without /checkpoint/everyEvents, the");
+  fEveryTimeCmd->SetGuidance("segments are sized from the measured time per event to");
+  fEveryTimeCmd->SetGuidance("end about every time; with it, the checkpoint is written");
+  fEveryTimeCmd->SetGuidance("at the end of the first segment after the time.");
+  fEveryTimeCmd->SetParameterName("time", false);
+  fEveryTimeCmd->SetRange("time >= 0.");
+  fEveryTimeCmd->SetUnitCategory("Time");
+  fEveryTimeCmd->SetDefaultUnit("min");
+  fEveryTimeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fBeamOnCmd = new G4UIcmdWithAnInteger("/checkpoint/beamOn", this);
+  fBeamOnCmd->SetGuidance("Run the events in segments of /checkpoint/everyEvents,");
+  fBeamOnCmd->SetGuidance("with a checkpoint after each of them.");
+  fBeamOnCmd->SetParameterName("nbEvents", false);
+  fBeamOnCmd->SetRange("nbEvents > 0");
+  fBeamOnCmd->AvailableForStates(G4State_Idle);
+
+  fRestartCmd = new G4UIcmdWithAString("/checkpoint/restart", this);
+  fRestartCmd->SetGuidance("Continue the job saved in a checkpoint file");
+  fRestartCmd->SetGuidance("  (default: the one of /checkpoint/file).");
+  fRestartCmd->SetGuidance("The macro must give the same geometry and scoring.");
+  fRestartCmd->SetParameterName("fileName", true);
+  fRestartCmd->SetDefaultValue("");
+  fRestartCmd->AvailableForStates(G4State_Idle);
+
+  fShardCmd = new G4UIcommand("/checkpoint/shard", this);
+  fShardCmd->SetGuidance("This job is one shard of a larger one:");
+  fShardCmd->SetGuidance("  shard index, number of shards.");
+  fShardCmd->SetGuidance("Each beamOn runs the share of the shard of its events;");
+  fShardCmd->SetGuidance("the seeds of the random engine are derived at the first");
+  fShardCmd->SetGuidance("run from the current seeds (/random/setSeeds) and the index;");
+  fShardCmd->SetGuidance("the sum of the job is written in <fileName>.shard<index>.");
+  G4UIparameter* indexPrm = new G4UIparameter("index",'i',false);
+  indexPrm->SetParameterRange("index >= 0");
+  fShardCmd->SetParameter(indexPrm);
+  G4UIparameter* countPrm = new G4UIparameter("nbShards",'i',false);
+  countPrm->SetParameterRange("nbShards > 0");
+  fShardCmd->SetParameter(countPrm);
+  fShardCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fMergeCmd = new G4UIcmdWithAString("/checkpoint/merge", this);
+  fMergeCmd->SetGuidance("Merge the files written by the shards of a job and write");
+  fMergeCmd->SetGuidance("the histograms and text files of the sum.");
+  fMergeCmd->SetGuidance("  e.g. /checkpoint/merge out.shard0 out.shard1");
+  fMergeCmd->SetGuidance("The macro must give the same geometry and scoring.");
+  fMergeCmd->SetParameterName("fileNames", false);
+  fMergeCmd->AvailableForStates(G4State_Idle);
+
+  fBeamUntilCmd = new G4UIcommand("/run/beamUntil", this, broadcast);
+  fBeamUntilCmd->SetGuidance("Run segments of events until the largest relative error");
+  fBeamUntilCmd->SetGuidance("of the bins firstBin to lastBin of a nuclide histogram");
+  fBeamUntilCmd->SetGuidance("is below the precision, or until the time budget");
+  fBeamUntilCmd->SetGuidance("or the maximum number of events (0: no limit) is reached.");
+  fBeamUntilCmd->SetGuidance("  e.g. /run/beamUntil 0.02 Al26 0 25 12 h");
+  fBeamUntilCmd->SetGuidance("The threads check the target every /checkpoint/snapshotEvents");
+  fBeamUntilCmd->SetGuidance("events; the segments have /checkpoint/everyEvents events,");
+  fBeamUntilCmd->SetGuidance("or a length estimated from the errors, of at least");
+  fBeamUntilCmd->SetGuidance("/checkpoint/minSegmentTime; checkpoints as with /checkpoint/beamOn.");
+  G4UIparameter* precisionPrm = new G4UIparameter("precision",'d',false);
+  precisionPrm->SetParameterRange("precision > 0.");
+  fBeamUntilCmd->SetParameter(precisionPrm);
+  G4UIparameter* nuclidePrm = new G4UIparameter("nuclide",'s',false);
+  fBeamUntilCmd->SetParameter(nuclidePrm);
+  G4UIparameter* firstPrm = new G4UIparameter("firstBin",'i',false);
+  firstPrm->SetParameterRange("firstBin >= 0");
+  fBeamUntilCmd->SetParameter(firstPrm);
+  G4UIparameter* lastPrm = new G4UIparameter("lastBin",'i',false);
+  lastPrm->SetParameterRange("lastBin >= 0");
+  fBeamUntilCmd->SetParameter(lastPrm);
+  G4UIparameter* timePrm = new G4UIparameter("maxTime",'d',true);
+  timePrm->SetDefaultValue(0.);
+  timePrm->SetParameterRange("maxTime >= 0.");
+  fBeamUntilCmd->SetParameter(timePrm);
+  G4UIparameter* unitPrm = new G4UIparameter("unit",'s',true);
+  unitPrm->SetDefaultValue("min");
+  unitPrm->SetParameterCandidates(G4UIcommand::UnitsList("Time"));
+  fBeamUntilCmd->SetParameter(unitPrm);
+  G4UIparameter* maxPrm = new G4UIparameter("maxEvents",'i',true);
+  maxPrm->SetDefaultValue(0);
+  maxPrm->SetParameterRange("maxEvents >= 0");
+  fBeamUntilCmd->SetParameter(maxPrm);
+  fBeamUntilCmd->AvailableForStates(G4State_Idle);
+
+  fMinSegmentTimeCmd = new G4UIcmdWithADoubleAndUnit("/checkpoint/minSegmentTime", this);
+  fMinSegmentTimeCmd->SetGuidance("Minimum duration of the segments of /run/beamUntil,");
+  fMinSegmentTimeCmd->SetGuidance("estimated from the time per event (default 10 min);");
+  fMinSegmentTimeCmd->SetGuidance("the threads wait for each other at the end of a segment.");
+  fMinSegmentTimeCmd->SetParameterName("time", false);
+  fMinSegmentTimeCmd->SetRange("time >= 0.");
+  fMinSegmentTimeCmd->SetUnitCategory("Time");
+  fMinSegmentTimeCmd->SetDefaultUnit("min");
+  fMinSegmentTimeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSnapshotEventsCmd = new G4UIcmdWithAnInteger("/checkpoint/snapshotEvents", this);
+  fSnapshotEventsCmd->SetGuidance("With /run/beamUntil, each thread publishes the sums of");
+  fSnapshotEventsCmd->SetGuidance("the target bins every nbEvents events (default 10).");
+  fSnapshotEventsCmd->SetParameterName("nbEvents", false);
+  fSnapshotEventsCmd->SetRange("nbEvents > 0");
+  fSnapshotEventsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+
+CheckpointMessenger::~CheckpointMessenger()
+{
+  delete fFileCmd;
+  delete fEveryEventsCmd;
+  delete fEveryTimeCmd;
+  delete fBeamOnCmd;
+  delete fRestartCmd;
+  delete fShardCmd;
+  delete fMergeCmd;
+  delete fBeamUntilCmd;
+  delete fMinSegmentTimeCmd;
+  delete fSnapshotEventsCmd;
+  delete fCheckpointDir;
+}
+
+
+void CheckpointMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fFileCmd)
+   { fCheckpoint->SetFileName(newValue);}
+
+  if (command == fEveryEventsCmd)
+   { fCheckpoint->SetEveryEvents(fEveryEventsCmd->GetNewIntValue(newValue));}
+
+  if (command == fEveryTimeCmd)
+   { fCheckpoint->SetEveryTime(fEveryTimeCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fBeamOnCmd)
+   { fCheckpoint->BeamOn(fBeamOnCmd->GetNewIntValue(newValue));}
+
+  if (command == fRestartCmd)
+   { fCheckpoint->Restart(newValue);}
+
+  if (command == fShardCmd)
+   {
+     G4int index, nbShards;
+     std::istringstream is(newValue);
+     is >> index >> nbShards;
+     fCheckpoint->SetShard(index, nbShards);
+   }
+
+  if (command == fMergeCmd)
+   {
+     std::vector<G4String> fileNames;
+     G4String name;
+     std::istringstream is(newValue);
+     while (is >> name) fileNames.push_back(name);
+     fCheckpoint->Merge(fileNames);
+   }
+
+  if (command == fMinSegmentTimeCmd)
+   { fCheckpoint->SetMinSegmentTime(fMinSegmentTimeCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fSnapshotEventsCmd)
+   { fCheckpoint->SetSnapshotEvents(fSnapshotEventsCmd->GetNewIntValue(newValue));}
+
+  if (command == fBeamUntilCmd)
+   {
+     G4double precision, maxTime;
+     G4String nuclide, unit;
+     G4int firstBin, lastBin, maxEvents;
+     std::istringstream is(newValue);
+     is >> precision >> nuclide >> firstBin >> lastBin >> maxTime >> unit
+        >> maxEvents;
+     fCheckpoint->BeamUntil(precision, nuclide, firstBin, lastBin,
+                            maxTime*G4UIcommand::ValueOf(unit), maxEvents);
+   }
+}
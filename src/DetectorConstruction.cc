@@ -48,13 +48,19 @@
 #include "G4SystemOfUnits.hh"
 #include "G4PhysicalConstants.hh"
 
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
 
 DetectorConstruction::DetectorConstruction()
 :G4VUserDetectorConstruction(),
- fMaterial(0), fLAbsor(0), fPAbsor(0), meteoriteMaterial(0),  fWorldMat(0), fPWorld(0), fDetectorMessenger(0)
+ fMaterial(0), fLAbsor(0), fPAbsor(0), meteoriteMaterial(0),  fWorldMat(0), fPWorld(0),
+ fSurfaceSource(false), fNbShells(0), fShellDepth(0.), fEqualMass(false), fDetectorMessenger(0)
 {
   fRadius = 241*m;  // Default value - it can be changed in a Macro
   fWorldSize = 1.01*fRadius;
+  ComputeShells();
   DefineMaterials();
   SetMaterial("Meteorite");  
   fDetectorMessenger = new DetectorMessenger(this);
@@ -202,22 +208,65 @@ G4VPhysicalVolume* DetectorConstruction::ConstructVolumes()
                             false,                        //no boolean operation
                             0);                           //copy number
                             
-  // Absorber
-  G4Sphere* 
-  sAbsor = new G4Sphere("Absorber",                       //name
-                      0., fRadius, 0., twopi, 0., pi);    //dimensions
-
-  fLAbsor = new G4LogicalVolume(sAbsor,                   //shape
-                              fMaterial,                  //material
-                              fMaterial->GetName());      //name
+  // Absorber: the whole sphere, or the core below the shells
+  ComputeShells();
+  G4double rCore = fShellRadii[fNbShells];
+  fLAbsor = 0;
+  fPAbsor = 0;
+  if (rCore > 0.) {
+    G4Sphere* 
+    sAbsor = new G4Sphere("Absorber",                     //name
+                        0., rCore, 0., twopi, 0., pi);    //dimensions
+
+    fLAbsor = new G4LogicalVolume(sAbsor,                 //shape
+                                fMaterial,                //material
+                                fMaterial->GetName());    //name
                                
-  fPAbsor = new G4PVPlacement(0,                          //no rotation
-                            G4ThreeVector(),              //at (0,0,0)
-                            fLAbsor,                      //logical volume
-                            fMaterial->GetName(),         //name
-                            lWorld,                       //mother  volume
-                            false,                        //no boolean operation
-                            0);                           //copy number
+    fPAbsor = new G4PVPlacement(0,                        //no rotation
+                              G4ThreeVector(),            //at (0,0,0)
+                              fLAbsor,                    //logical volume
+                              fMaterial->GetName(),       //name
+                              lWorld,                     //mother  volume
+                              false,                      //no boolean operation
+                              fNbShells + 1);             //copy number
+  }
+
+  // Shells, from the surface inwards
+  fLShells.clear();
+  for (G4int i=0; i<fNbShells; i++) {
+    G4Material* material = GetShellMaterial(i);
+    G4Sphere* sShell = new G4Sphere("Shell",
+                          fShellRadii[i+1], fShellRadii[i], 0., twopi, 0., pi);
+    G4LogicalVolume* lShell = new G4LogicalVolume(sShell, material,
+                                                  material->GetName());
+    new G4PVPlacement(0,                                  //no rotation
+                      G4ThreeVector(),                    //at (0,0,0)
+                      lShell,                             //logical volume
+                      "Shell_" + material->GetName(),     //name
+                      lWorld,                             //mother  volume
+                      false,                              //no boolean operation
+                      i + 1);                             //copy number
+    fLShells.push_back(lShell);
+  }
+
+  // Sweep materials: a tiny box of each one in a corner of the world, out
+  // of reach of the primaries, so that their physics tables are built at
+  // initialization and a change of material needs no physics rebuild
+  G4double bankSize = 1*um;
+  for (size_t i=0; i<fSweepMaterials.size(); i++) {
+    G4Material* material = fSweepMaterials[i];
+    G4Box* sBank = new G4Box("Bank", bankSize, bankSize, bankSize);
+    G4LogicalVolume* lBank = new G4LogicalVolume(sBank, material, "Bank");
+    G4double corner = fWorldSize - (4*i + 2)*bankSize;
+    new G4PVPlacement(0,                                  //no rotation
+                      G4ThreeVector(corner, corner, corner),
+                      lBank,                              //logical volume
+                      "Bank_" + material->GetName(),      //name
+                      lWorld,                             //mother  volume
+                      false,                              //no boolean operation
+                      0);                                 //copy number
+  }
+
   PrintParameters();
   
   //always return the root volume
@@ -230,6 +279,19 @@ void DetectorConstruction::PrintParameters()
   G4cout << "\n The Absorber is " << G4BestUnit(fRadius,"Length")
          << " of " << fMaterial->GetName() 
          << "\n \n" << fMaterial << G4endl;
+
+  if (fNbShells == 0) return;
+  G4cout << "\n Outer " << G4BestUnit(fShellDepth,"Length") << " in "
+         << fNbShells << (fEqualMass ? " equal-mass" : " equal-depth")
+         << " shells :" << G4endl;
+  for (G4int i=0; i<=fNbShells; i++) {
+    G4cout << "  " << std::setw(4) << i
+           << "  depth " << std::setw(10) << G4BestUnit(fRadius - GetShellRmax(i),"Length")
+           << " --> " << std::setw(10) << G4BestUnit(fRadius - GetShellRmin(i),"Length")
+           << "  " << std::setw(12) << GetShellMaterial(i)->GetName()
+           << "  mass " << G4BestUnit(GetShellMass(i),"Mass")
+           << (i == fNbShells ? "  (core)" : "") << G4endl;
+  }
 }
 
 
@@ -242,7 +304,19 @@ void DetectorConstruction::SetMaterial(G4String materialChoice)
   if (pttoMaterial) { 
     fMaterial = pttoMaterial;
     if(fLAbsor) { fLAbsor->SetMaterial(fMaterial); }
-    G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+    for (size_t i=0; i<fLShells.size(); i++) {
+      if (!fShellMaterials[i]) fLShells[i]->SetMaterial(fMaterial);
+    }
+    // physics tables of the sweep materials are already built
+    if (std::find(fSweepMaterials.begin(), fSweepMaterials.end(), fMaterial)
+        != fSweepMaterials.end()) {
+      if(fPWorld) G4RunManager::GetRunManager()->ReinitializeGeometry();
+    }
+    else {
+      G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+      if (fEqualMass && fNbShells > 0 && fPWorld)
+        G4RunManager::GetRunManager()->ReinitializeGeometry();
+    }
   }
   else {
     G4cout << "\n--> warning from DetectorConstruction::SetMaterial : "
@@ -254,13 +328,141 @@ void DetectorConstruction::SetMaterial(G4String materialChoice)
 void DetectorConstruction::SetRadius(G4double value)
 {
   fRadius = value;
+  fWorldSize = 1.01*fRadius;
   G4RunManager::GetRunManager()->ReinitializeGeometry();
 }
 
 
+void DetectorConstruction::SetSweepRadii(const std::vector<G4double>& radii)
+{
+  fSweepRadii = radii;
+}
+
+
+void DetectorConstruction::SetSweepMaterials(const std::vector<G4String>& names)
+{
+  fSweepMaterials.clear();
+  for (size_t i=0; i<names.size(); i++) {
+    G4Material* material =
+      G4NistManager::Instance()->FindOrBuildMaterial(names[i]);
+    if (material) {
+      fSweepMaterials.push_back(material);
+    }
+    else {
+      G4cout << "\n--> warning from DetectorConstruction::SetSweepMaterials : "
+             << names[i] << " not found" << G4endl;
+    }
+  }
+  // new materials: their tables are built once, at the next run
+  if(fPWorld) G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+
+void DetectorConstruction::SetShells(G4int nbShells, G4double depth,
+                                     G4bool equalMass)
+{
+  fNbShells   = std::max(nbShells, 0);
+  fShellDepth = depth;
+  fEqualMass  = equalMass;
+  fShellMaterials.resize(fNbShells, 0);
+  fLShells.clear();
+  ComputeShells();
+  if(fPWorld) G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+
+void DetectorConstruction::SetShellMaterial(G4int first, G4int last,
+                                            G4String materialChoice)
+{
+  G4Material* material =
+     G4NistManager::Instance()->FindOrBuildMaterial(materialChoice);
+  if (!material) {
+    G4cout << "\n--> warning from DetectorConstruction::SetShellMaterial : "
+           << materialChoice << " not found" << G4endl;
+    return;
+  }
+  if (first < 0 || last >= fNbShells || first > last) {
+    G4cout << "\n--> warning from DetectorConstruction::SetShellMaterial : "
+           << "shells " << first << " to " << last << " out of 0 - "
+           << fNbShells - 1 << G4endl;
+    return;
+  }
+
+  for (G4int i=first; i<=last; i++) {
+    fShellMaterials[i] = material;
+    if (i < G4int(fLShells.size())) fLShells[i]->SetMaterial(material);
+  }
+  G4RunManager::GetRunManager()->PhysicsHasBeenModified();
+  // the radii of equal-mass shells depend on their densities
+  if (fEqualMass && fPWorld) G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+
+void DetectorConstruction::ComputeShells()
+{
+  // radii of the shell boundaries, from the surface to the center
+  G4double depth = std::min(fShellDepth, fRadius);
+  G4double rCore = fRadius - depth;
+  fShellRadii.assign(fNbShells + 2, 0.);
+  for (G4int i=0; i<=fNbShells; i++) {
+    G4double f = (fNbShells > 0) ? G4double(i)/fNbShells : 1.;
+    fShellRadii[i] = fRadius - f*depth;
+  }
+  if (fNbShells == 0) fShellRadii[0] = fRadius;
+
+  // equal masses with the density of each shell: the mass m of a shell
+  // is the one for which the sum of their volumes m/density_i fills the
+  // layer, then each shell takes the volume m/density_i from the outside
+  if (fEqualMass && fNbShells > 0) {
+    G4double r3 = fRadius*fRadius*fRadius;
+    G4double invDensity = 0.;
+    for (G4int i=0; i<fNbShells; i++)
+      invDensity += 1./GetShellMaterial(i)->GetDensity();
+    G4double mass = 4./3*pi*(r3 - rCore*rCore*rCore)/invDensity;
+    for (G4int i=1; i<fNbShells; i++) {
+      r3 -= mass/(4./3*pi*GetShellMaterial(i-1)->GetDensity());
+      fShellRadii[i] = std::cbrt(std::max(r3, 0.));
+    }
+  }
+}
+
+
+G4Material* DetectorConstruction::GetShellMaterial(G4int i)
+{
+  if (i < fNbShells && fShellMaterials[i]) return fShellMaterials[i];
+  return fMaterial;
+}
+
+
+G4double DetectorConstruction::GetShellMass(G4int i)
+{
+  G4double rmax = GetShellRmax(i), rmin = GetShellRmin(i);
+  G4double volume = 4./3*pi*(rmax*rmax*rmax - rmin*rmin*rmin);
+  return volume*GetShellMaterial(i)->GetDensity();
+}
+
+
+G4double DetectorConstruction::GetLayerMass(G4double depthMin, G4double depthMax)
+{
+  G4double rmax = fRadius - std::max(depthMin, 0.);
+  G4double rmin = fRadius - std::min(depthMax, fRadius);
+  if (rmax <= rmin) return 0.;
+
+  // overlap with each shell, then with the core (shell fNbShells, rmin 0)
+  G4double mass = 0.;
+  for (G4int i=0; i<=fNbShells; i++) {
+    G4double r1 = std::min(rmax, GetShellRmax(i));
+    G4double r0 = std::max(rmin, (i < fNbShells) ? GetShellRmin(i) : 0.);
+    if (r1 <= r0) continue;
+    mass += 4./3*pi*(r1*r1*r1 - r0*r0*r0)*GetShellMaterial(i)->GetDensity();
+  }
+  return mass;
+}
+
+
 G4double DetectorConstruction::GetVolume()
 {
   G4double volume;
-  volume = 4/3 * 3.14159 * fRadius*fRadius*fRadius;
+  volume = 4./3 * pi * fRadius*fRadius*fRadius;
   return volume;
 }
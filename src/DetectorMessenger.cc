@@ -37,12 +37,20 @@
 #include "G4UIcmdWithAString.hh"
 #include "G4UIcmdWithADoubleAndUnit.hh"
 #include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UImanager.hh"
+#include "G4Material.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#include "HistoManager.hh"
 
 
 DetectorMessenger::DetectorMessenger(DetectorConstruction * Det)
 :G4UImessenger(), 
  fDetector(Det), fTestemDir(0), fDetDir(0), fMaterCmd(0), fSizeCmd(0),
- fIsotopeCmd(0)
+ fIsotopeCmd(0), fShellsCmd(0), fShellMatCmd(0), fSweepDir(0), fSweepRadiiCmd(0), fSweepMatCmd(0),
+ fSweepBeamOnCmd(0)
 { 
   fTestemDir = new G4UIdirectory("/testhadr/");
   fTestemDir->SetGuidance("commands specific to this example");
@@ -93,6 +101,89 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction * Det)
   fIsotopeCmd->SetParameter(unitPrm);
   //
   fIsotopeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);  
+
+  fShellsCmd = new G4UIcommand("/testhadr/det/setShells", this);
+  fShellsCmd->SetGuidance("Divide the outer layer of the sphere in concentric shells");
+  fShellsCmd->SetGuidance("  number of shells (0: one sphere), total depth, unit,");
+  fShellsCmd->SetGuidance("  equalDepth or equalMass shells (with the density");
+  fShellsCmd->SetGuidance("  of each shell, from /testhadr/det/setShellMat).");
+  fShellsCmd->SetGuidance("Production is scored per shell; the rest is the core.");
+  //
+  G4UIparameter* nbPrm = new G4UIparameter("nbShells", 'i', false);
+  nbPrm->SetGuidance("number of shells");
+  nbPrm->SetParameterRange("nbShells >= 0");
+  fShellsCmd->SetParameter(nbPrm);
+  //
+  G4UIparameter* depthPrm = new G4UIparameter("depth", 'd', false);
+  depthPrm->SetGuidance("depth of the innermost shell boundary");
+  depthPrm->SetParameterRange("depth >= 0.");
+  fShellsCmd->SetParameter(depthPrm);
+  //
+  G4UIparameter* depthUnitPrm = new G4UIparameter("unit", 's', false);
+  depthUnitPrm->SetGuidance("unit of depth");
+  depthUnitPrm->SetParameterCandidates(
+                  G4UIcommand::UnitsList(G4UIcommand::CategoryOf("m")));
+  fShellsCmd->SetParameter(depthUnitPrm);
+  //
+  G4UIparameter* modePrm = new G4UIparameter("mode", 's', true);
+  modePrm->SetGuidance("thickness of the shells");
+  modePrm->SetParameterCandidates("equalDepth equalMass");
+  modePrm->SetDefaultValue("equalDepth");
+  fShellsCmd->SetParameter(modePrm);
+  //
+  fShellsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fShellMatCmd = new G4UIcommand("/testhadr/det/setShellMat", this);
+  fShellMatCmd->SetGuidance("Material of the shells first to last");
+  fShellMatCmd->SetGuidance("  (0 is at the surface; default: material of the sphere)");
+  //
+  G4UIparameter* firstPrm = new G4UIparameter("first", 'i', false);
+  firstPrm->SetParameterRange("first >= 0");
+  fShellMatCmd->SetParameter(firstPrm);
+  //
+  G4UIparameter* lastPrm = new G4UIparameter("last", 'i', false);
+  lastPrm->SetParameterRange("last >= 0");
+  fShellMatCmd->SetParameter(lastPrm);
+  //
+  G4UIparameter* matPrm = new G4UIparameter("material", 's', false);
+  fShellMatCmd->SetParameter(matPrm);
+  //
+  fShellMatCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSweepDir = new G4UIdirectory("/testhadr/sweep/", broadcast);
+  fSweepDir->SetGuidance("consecutive runs over radii and materials");
+
+  fSweepRadiiCmd = new G4UIcmdWithAString("/testhadr/sweep/radii", this);
+  fSweepRadiiCmd->SetGuidance("List of radii of the sphere, followed by the unit");
+  fSweepRadiiCmd->SetGuidance("  e.g. /testhadr/sweep/radii 0.45 10 241 m");
+  fSweepRadiiCmd->SetParameterName("radii", false);
+  fSweepRadiiCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSweepMatCmd = new G4UIcmdWithAString("/testhadr/sweep/materials", this);
+  fSweepMatCmd->SetGuidance("List of materials of the sphere.");
+  fSweepMatCmd->SetGuidance("Their physics tables are all built at the first run,");
+  fSweepMatCmd->SetGuidance("give them before /run/initialize.");
+  fSweepMatCmd->SetParameterName("materials", false);
+  fSweepMatCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSweepBeamOnCmd = new G4UIcommand("/testhadr/sweep/beamOn", this);
+  fSweepBeamOnCmd->SetGuidance("One run for each material and radius of the lists,");
+  fSweepBeamOnCmd->SetGuidance("each written in <fileName>_<material>_<radius>.");
+  fSweepBeamOnCmd->SetGuidance("  position surface : primaries on the surface of each");
+  fSweepBeamOnCmd->SetGuidance("                     sphere, during the sweep only");
+  fSweepBeamOnCmd->SetGuidance("  position source  : the current /source/position");
+  fSweepBeamOnCmd->SetGuidance("The material and radius are restored after the sweep.");
+  //
+  G4UIparameter* eventsPrm = new G4UIparameter("nEvents", 'i', false);
+  eventsPrm->SetParameterRange("nEvents >= 0");
+  fSweepBeamOnCmd->SetParameter(eventsPrm);
+  //
+  G4UIparameter* positionPrm = new G4UIparameter("position", 's', true);
+  positionPrm->SetParameterCandidates("surface source");
+  positionPrm->SetDefaultValue("surface");
+  fSweepBeamOnCmd->SetParameter(positionPrm);
+  //
+  fSweepBeamOnCmd->AvailableForStates(G4State_Idle);
 }
 
 
@@ -101,6 +192,12 @@ DetectorMessenger::~DetectorMessenger()
   delete fMaterCmd;
   delete fSizeCmd;
   delete fIsotopeCmd;
+  delete fShellsCmd;
+  delete fShellMatCmd;
+  delete fSweepRadiiCmd;
+  delete fSweepMatCmd;
+  delete fSweepBeamOnCmd;
+  delete fSweepDir;
   delete fDetDir;
   delete fTestemDir;
 }
@@ -110,6 +207,9 @@ void DetectorMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
 { 
   if( command == fMaterCmd )
    { fDetector->SetMaterial(newValue);}
+
+  if( command == fSizeCmd )
+   { fDetector->SetRadius(fSizeCmd->GetNewDoubleValue(newValue));}
      
   if (command == fIsotopeCmd)
    {
@@ -121,4 +221,94 @@ void DetectorMessenger::SetNewValue(G4UIcommand* command,G4String newValue)
      fDetector->MaterialWithSingleIsotope (name,name,dens,Z,A);
      fDetector->SetMaterial(name);    
    }   
+
+  if (command == fShellsCmd)
+   {
+     G4int nbShells; G4double depth;
+     G4String unt, mode = "equalDepth";
+     std::istringstream is(newValue);
+     is >> nbShells >> depth >> unt >> mode;
+     depth *= G4UIcommand::ValueOf(unt);
+     fDetector->SetShells(nbShells, depth, mode == "equalMass");
+   }
+
+  if (command == fShellMatCmd)
+   {
+     G4int first, last;
+     G4String name;
+     std::istringstream is(newValue);
+     is >> first >> last >> name;
+     fDetector->SetShellMaterial(first, last, name);
+   }
+
+  if (command == fSweepRadiiCmd)
+   {
+     std::vector<G4String> tokens;
+     G4String token;
+     std::istringstream is(newValue);
+     while (is >> token) tokens.push_back(token);
+     std::vector<G4double> radii;
+     if (tokens.size() > 1) {
+       G4double unit = G4UIcommand::ValueOf(tokens.back());
+       for (size_t i=0; i<tokens.size()-1; i++)
+         radii.push_back(G4UIcommand::ConvertToDouble(tokens[i])*unit);
+     }
+     fDetector->SetSweepRadii(radii);
+   }
+
+  if (command == fSweepMatCmd)
+   {
+     std::vector<G4String> names;
+     G4String name;
+     std::istringstream is(newValue);
+     while (is >> name) names.push_back(name);
+     fDetector->SetSweepMaterials(names);
+   }
+
+  if (command == fSweepBeamOnCmd)
+   {
+     G4int nEvents;
+     G4String position = "surface";
+     std::istringstream is(newValue);
+     is >> nEvents >> position;
+     RunSweep(nEvents, position == "surface");
+   }
+}
+
+
+void DetectorMessenger::RunSweep(G4int nEvents, G4bool surface)
+{
+  // empty lists: current radius or material
+  std::vector<G4double> radii = fDetector->GetSweepRadii();
+  if (radii.empty()) radii.push_back(fDetector->GetRadius());
+  std::vector<G4Material*> materials = fDetector->GetSweepMaterials();
+  if (materials.empty()) materials.push_back(fDetector->GetMaterial());
+
+  // a GPS source of fixed size does not follow the radius (and is outside
+  // the world for the larger spheres): primaries on the target surface,
+  // for the runs of the sweep only
+  fDetector->SetSurfaceSource(surface);
+  if (surface) G4cout << "\n Sweep : primaries sampled on the sphere surface"
+                      << G4endl;
+
+  G4UImanager* UImanager = G4UImanager::GetUIpointer();
+  G4String fileName = G4AnalysisManager::Instance()->GetFileName();
+  G4String material = fDetector->GetMaterial()->GetName();
+  G4double radius = fDetector->GetRadius();
+  for (size_t im=0; im<materials.size(); im++) {
+    fDetector->SetMaterial(materials[im]->GetName());
+    for (size_t ir=0; ir<radii.size(); ir++) {
+      fDetector->SetRadius(radii[ir]);
+      G4String tag = materials[im]->GetName() + "_"
+                   + G4UIcommand::ConvertToString(radii[ir]/m) + "m";
+      G4cout << "\n---> sweep run " << im*radii.size() + ir + 1 << "/"
+             << materials.size()*radii.size() << " : " << tag << G4endl;
+      UImanager->ApplyCommand("/analysis/setFileName " + fileName + "_" + tag);
+      UImanager->ApplyCommand("/run/beamOn " + G4UIcommand::ConvertToString(nEvents));
+    }
+  }
+  UImanager->ApplyCommand("/analysis/setFileName " + fileName);
+  fDetector->SetMaterial(material);
+  fDetector->SetRadius(radius);
+  fDetector->SetSurfaceSource(false);
 }
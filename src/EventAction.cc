@@ -32,15 +32,106 @@
 
 #include "Run.hh"
 #include "HistoManager.hh"
+#include "NuclideScorer.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "GCRSpectrum.hh"
+#include "MixedSource.hh"
+#include "Checkpoint.hh"
 
 #include "G4Event.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
 #include "G4RunManager.hh"
 #include "G4UnitsTable.hh"
 
 
-EventAction::EventAction()
+EventAction::EventAction(PrimaryGeneratorAction* prim, NuclideScorer* scorer,
+                         Checkpoint* checkpoint)
+: G4UserEventAction(),
+  fPrimary(prim), fScorer(scorer), fCheckpoint(checkpoint), fNbSinceSnapshot(0),
+  fPrimaryEnergy(0.), fResponsePoint(-1), fSpecies(-1), fRunID(-1)
 {}
 
 
 EventAction::~EventAction()
 {}
+
+
+void EventAction::BeginOfEventAction(const G4Event* event)
+{
+  fTimer.Start();
+  const G4PrimaryParticle* primary = event->GetPrimaryVertex()->GetPrimary();
+  fPrimaryEnergy = primary->GetKineticEnergy();
+
+  // species tag of the primary, for the production per species
+  fSpecies = -1;
+  if (fPrimary->GetSourceMode() == "mixed") {
+    fSpecies = fPrimary->GetMixedSource()->GetSpecies(primary->GetG4code());
+    if (fSpecies >= 0) {
+      Run* run = static_cast<Run*>(
+            G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+      run->CountSpeciesPrimary(fSpecies);
+    }
+  }
+
+  // primaries of each point of the response grid
+  fResponsePoint = fScorer->GetResponsePoint(fPrimaryEnergy);
+  if (fResponsePoint >= 0) {
+    Run* run = static_cast<Run*>(
+          G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+    run->CountResponsePrimary(fResponsePoint);
+  }
+
+  G4int nphi = fScorer->GetNbPhi();
+  if (nphi == 0) return;
+
+  G4int runID = G4RunManager::GetRunManager()->GetCurrentRun()->GetRunID();
+  if (runID != fRunID) {
+    fRunID = runID;
+    ComputePhiNormalization();
+  }
+
+  // without the analytic reference spectrum, the weights stay null
+  if (fPhiNorm.empty()) return;
+  GCRSpectrum* gcr = fPrimary->GetGCRSpectrum();
+  G4double jref = gcr->Flux(fPrimaryEnergy);
+  for (G4int iphi=0; iphi<nphi; iphi++) {
+    fPhiWeights[iphi] = (jref > 0.) ?
+      fPhiNorm[iphi]*gcr->Flux(fPrimaryEnergy, fScorer->GetPhi(iphi))/jref : 0.;
+  }
+}
+
+
+void EventAction::EndOfEventAction(const G4Event*)
+{
+  // busy time of this thread
+  fTimer.Stop();
+  Run* run = static_cast<Run*>(
+        G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+  run->AddBusyTime(fTimer.GetRealElapsed());
+
+  // adaptive job: sums of this thread for the precision target, and end
+  // of the segment after this event once it is reached
+  if (!fCheckpoint->IsAdaptive()) return;
+  if (++fNbSinceSnapshot >= fCheckpoint->GetSnapshotEvents()) {
+    fNbSinceSnapshot = 0;
+    fCheckpoint->Snapshot(run);
+  }
+  if (fCheckpoint->IsStopRequested()) G4RunManager::GetRunManager()->AbortRun(true);
+}
+
+
+void EventAction::ComputePhiNormalization()
+{
+  G4int nphi = fScorer->GetNbPhi();
+  fPhiWeights.assign(nphi, 0.);
+  fPhiNorm.clear();
+  if (fPrimary->GetSourceMode() != "gcr") return;
+
+  // same number of primaries: the spectra are normalized to unit integral
+  GCRSpectrum* gcr = fPrimary->GetGCRSpectrum();
+  G4double iref = gcr->IntegralFlux(gcr->GetPhi());
+  for (G4int iphi=0; iphi<nphi; iphi++) {
+    fPhiNorm.push_back(iref/gcr->IntegralFlux(fScorer->GetPhi(iphi)));
+  }
+}
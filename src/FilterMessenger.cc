@@ -0,0 +1,98 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file FilterMessenger.cc
+/// \brief Implementation of the FilterMessenger class
+
+#include "FilterMessenger.hh"
+#include "ProductionFilter.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithABool.hh"
+
+
+FilterMessenger::FilterMessenger(ProductionFilter* filter)
+:G4UImessenger(),
+ fFilter(filter), fStackDir(0), fActiveCmd(0), fThresholdCmd(0)
+{
+  G4bool broadcast = false;
+  fStackDir = new G4UIdirectory("/testhadr/stack/", broadcast);
+  fStackDir->SetGuidance("kill the tracks that cannot produce scored nuclides");
+
+  fActiveCmd = new G4UIcmdWithABool("/testhadr/stack/killIrrelevant", this);
+  fActiveCmd->SetGuidance("Kill at birth the secondaries below the threshold");
+  fActiveCmd->SetGuidance("of their species, the neutrinos, and the tracks");
+  fActiveCmd->SetGuidance("leaving the meteorite (default false).");
+  fActiveCmd->SetParameterName("flag", true);
+  fActiveCmd->SetDefaultValue(true);
+  fActiveCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fThresholdCmd = new G4UIcommand("/testhadr/stack/threshold", this);
+  fThresholdCmd->SetGuidance("Set the kill threshold of a species");
+  fThresholdCmd->SetGuidance("  (default: gamma, e- and e+ from the scored nuclides;");
+  fThresholdCmd->SetGuidance("  0: the species is never killed)");
+  fThresholdCmd->SetGuidance("  particle, kinetic energy, unit");
+  //
+  G4UIparameter* particlePrm = new G4UIparameter("particle", 's', false);
+  fThresholdCmd->SetParameter(particlePrm);
+  //
+  G4UIparameter* energyPrm = new G4UIparameter("energy", 'd', false);
+  energyPrm->SetParameterRange("energy >= 0.");
+  fThresholdCmd->SetParameter(energyPrm);
+  //
+  G4UIparameter* unitPrm = new G4UIparameter("unit", 's', true);
+  unitPrm->SetDefaultValue("MeV");
+  unitPrm->SetParameterCandidates(G4UIcommand::UnitsList("Energy"));
+  fThresholdCmd->SetParameter(unitPrm);
+  //
+  fThresholdCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+
+FilterMessenger::~FilterMessenger()
+{
+  delete fActiveCmd;
+  delete fThresholdCmd;
+  delete fStackDir;
+}
+
+
+void FilterMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fActiveCmd)
+   { fFilter->SetActive(fActiveCmd->GetNewBoolValue(newValue));}
+
+  if (command == fThresholdCmd)
+   {
+     G4String particle, unit;
+     G4double energy;
+     std::istringstream is(newValue);
+     is >> particle >> energy >> unit;
+     fFilter->SetThreshold(particle, energy*G4UIcommand::ValueOf(unit));
+   }
+}
@@ -0,0 +1,165 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file GCRSpectrum.cc
+/// \brief Implementation of the GCRSpectrum class
+
+#include "GCRSpectrum.hh"
+
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+
+
+GCRSpectrum::GCRSpectrum()
+: fParticle(0), fIsAlpha(false), fPhi(660*MeV), fEmin(1*MeV), fEmax(100*GeV),
+  fNbPoints(2000), fTableIsValid(false)
+{
+  SetParticle("proton");
+}
+
+
+GCRSpectrum::~GCRSpectrum()
+{}
+
+
+G4double GCRSpectrum::ProtonFlux(G4double ekin, G4double phi)
+{
+  // GCR_energyMacro_proton.m
+  const G4double A  = 9.9e8;            // particles/(MeV m2 sr s)
+  const G4double mp = 938.27208816;     // MeV
+  G4double E = ekin/MeV, p = phi/MeV;
+  G4double x = 780.*std::exp(-2.5e-4*E);
+  return A*E*(E + 2*mp)*std::pow(E + x + p, -2.65)/((E + p)*(E + 2*mp + p));
+}
+
+
+G4double GCRSpectrum::AlphaFlux(G4double ekin, G4double phi)
+{
+  // GCR_energyMacro_alpha.m: the modulation enters through the index k
+  const G4double C = 5.5e7;             // particles/(MeV m2 sr s)
+  const G4double m = 3727.379378;       // MeV
+  G4double E = ekin/MeV;
+  G4double k = (phi/MeV)*1.786e-3 - 0.1323;
+  return C*std::pow(E, k)*(E + 2*m)
+         /((E + 700.)*(E + 2*m + 700.)
+           *std::pow(E + 312500.*std::pow(E, -2.5) + 700., 1.65 + k));
+}
+
+
+G4double GCRSpectrum::Flux(G4double ekin, G4double phi) const
+{
+  return fIsAlpha ? AlphaFlux(ekin, phi) : ProtonFlux(ekin, phi);
+}
+
+
+void GCRSpectrum::SetParticle(const G4String& name)
+{
+  G4ParticleDefinition* particle =
+    G4ParticleTable::GetParticleTable()->FindParticle(name);
+  if (!particle || (name != "proton" && name != "alpha")) {
+    G4cout << "\n--> warning from GCRSpectrum::SetParticle : "
+           << name << " has no GCR spectrum (proton, alpha)" << G4endl;
+    return;
+  }
+  fParticle = particle;
+  fIsAlpha = (name == "alpha");
+  fTableIsValid = false;
+}
+
+
+void GCRSpectrum::SetPhi(G4double phi)
+{
+  fPhi = phi;
+  fTableIsValid = false;
+}
+
+
+void GCRSpectrum::SetEnergyRange(G4double emin, G4double emax)
+{
+  if (emin <= 0. || emax <= emin) {
+    G4cout << "\n--> warning from GCRSpectrum::SetEnergyRange : "
+           << "wrong range " << G4BestUnit(emin, "Energy") << " - "
+           << G4BestUnit(emax, "Energy") << G4endl;
+    return;
+  }
+  fEmin = emin;
+  fEmax = emax;
+  fTableIsValid = false;
+}
+
+
+void GCRSpectrum::SetNbPoints(G4int n)
+{
+  fNbPoints = n;
+  fTableIsValid = false;
+}
+
+
+G4double GCRSpectrum::IntegralFlux(G4double phi) const
+{
+  // same grid as the sampling table, for any modulation parameter
+  G4double dlog = std::log(fEmax/fEmin)/(fNbPoints - 1);
+  G4double integral = 0.;
+  G4double e0 = fEmin, j0 = Flux(e0, phi);
+  for (G4int i=1; i<fNbPoints; i++) {
+    G4double e1 = (i == fNbPoints-1) ? fEmax : fEmin*std::exp(i*dlog);
+    G4double j1 = Flux(e1, phi);
+    integral += SpectrumSampler::BinIntegral(e0, e1, j0, j1);
+    e0 = e1; j0 = j1;
+  }
+  return integral/MeV;
+}
+
+
+void GCRSpectrum::BuildTable()
+{
+  // log grid: the power law interpolation is then very close to the formula
+  std::vector<G4double> energies(fNbPoints), flux(fNbPoints);
+  G4double dlog = std::log(fEmax/fEmin)/(fNbPoints - 1);
+  for (G4int i=0; i<fNbPoints; i++) {
+    energies[i] = (i == fNbPoints-1) ? fEmax : fEmin*std::exp(i*dlog);
+    flux[i] = Flux(energies[i]);
+  }
+  fSampler.SetTable(energies, flux);
+  fTableIsValid = true;
+}
+
+
+G4double GCRSpectrum::Sample()
+{
+  if (!fTableIsValid) BuildTable();
+  return fSampler.Sample();
+}
+
+
+G4double GCRSpectrum::GetIntegralFlux()
+{
+  // particles/(m2 sr s) between Emin and Emax
+  if (!fTableIsValid) BuildTable();
+  return fSampler.GetIntegral()/MeV;
+}
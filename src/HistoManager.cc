@@ -29,12 +29,16 @@
 /// \brief Implementation of the HistoManager class
 
 #include "HistoManager.hh"
+#include "NuclideScorer.hh"
+#include "Run.hh"
+#include "G4UIcommand.hh"
+#include "G4Threading.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 
 
-HistoManager::HistoManager()
-  : fFileName("RadionuclidesProduction")
+HistoManager::HistoManager(NuclideScorer* scorer)
+  : fFileName("RadionuclidesProduction"), fScorer(scorer)
 {
   Book();
 }
@@ -56,29 +60,136 @@ void HistoManager::Book()
   analysisManager->SetVerboseLevel(1);
   analysisManager->SetActivation(true);     //enable inactivation of histograms
   
-  // Define histograms start values
-  const G4int kMaxHisto = 9;
-  const G4String id[] = {"0", "1", "2", "3", "4", "5", "6", "7", "8"};    // Radionuclides
-  const G4String title[] = {"Al26 number",            //0
-                            "Mn54 number",            //1
-                            "Co57 number",            //2
-                            "Na22 number",            //3
-                            "Co60 number",            //4
-                            "Ti44 number",            //5
-                            "Ca41 number",            //6
-                            "Cl36 number",            //7
-                            "Be10 number",            //8
-                           };
+  // Histograms of the scored radionuclides; the ones added later
+  // via /scoring/ commands are booked by the ScoringMessenger
+  for (G4int k=0; k<fScorer->GetNbHistos(); k++) {
+    BookHisto(k, fScorer->GetHistoTitle(k));
+  }
+
+  // Records of the scored radionuclides, activated by /scoring/nuclide/records.
+  // The workers fill their own ntuple; its baskets are sent to the
+  // master file when full.
+  if (G4Threading::IsMultithreadedApplication())
+    analysisManager->SetNtupleMerging(true);
+  G4int id = analysisManager->CreateNtuple("nuclides", "Produced radionuclides");
+  analysisManager->CreateNtupleIColumn("Z");
+  analysisManager->CreateNtupleIColumn("A");
+  analysisManager->CreateNtupleDColumn("depth");
+  analysisManager->CreateNtupleDColumn("energy");
+  analysisManager->CreateNtupleIColumn("parent");
+  analysisManager->CreateNtupleDColumn("primaryEnergy");
+  analysisManager->CreateNtupleDColumn("weight");
+  analysisManager->FinishNtuple();
+  analysisManager->SetNtupleActivation(id, false);
+}
+
+
+G4int HistoManager::BookHisto(G4int id, const G4String& title)
+{
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+
   // Default values (to be reset via /analysis/h1/set command) 
   G4int nbins     = 100;
   G4double rmin   = -1*cm;
   G4double rmax   = 1*cm;
 
-  // Create all histograms as inactivated 
+  // Create histogram as inactivated 
   // as we have not yet set nbins, vmin, vmax
-  for (G4int k=0; k<kMaxHisto; k++) { 
-  G4int ih = analysisManager->CreateH1(id[k], title[k], nbins, rmin, rmax);
+  G4int ih = analysisManager->CreateH1(G4UIcommand::ConvertToString(id),
+                                       title, nbins, rmin, rmax);
   analysisManager->SetH1Activation(ih, false);
+  return ih;
+}
+
+
+void HistoManager::SetBinning()
+{
+  // reweighted and activity histograms take the binning
+  // of their nuclide histogram
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  for (G4int id=0; id<fScorer->GetNbHistos(); id++) {
+    if (fScorer->GetHistoPhi(id) < 0 && !fScorer->IsActivityHisto(id)) continue;
+    G4int ih = fScorer->GetHistoId(fScorer->GetHistoNuclide(id));
+
+    // axis limits are stored in the histogram unit
+    G4double unit = analysisManager->GetH1Unit(ih);
+    analysisManager->SetH1(id, analysisManager->GetH1Nbins(ih),
+                           analysisManager->GetH1Xmin(ih)*unit,
+                           analysisManager->GetH1Xmax(ih)*unit,
+                           UnitSymbol(unit, "Length"));
+    analysisManager->SetH1Activation(id, analysisManager->GetH1Activation(ih));
+  }
+}
+
+
+void HistoManager::SetBinContent(G4int id, G4int bin, G4int entries,
+                                 G4double sumw, G4double sumw2)
+{
+  // bin 0 is the underflow, nbins+1 the overflow;
+  // the error of the bin is sqrt(sumw2)
+  tools::histo::h1d* h1 = G4AnalysisManager::Instance()->GetH1(id);
+  if (!h1) return;
+  G4double x = 0.;
+  if (bin > 0 && bin <= G4int(h1->axis().bins())) {
+    x = 0.5*(h1->axis().bin_lower_edge(bin-1)
+           + h1->axis().bin_upper_edge(bin-1));
   }
+  h1->set_bin_content(bin, entries, sumw, sumw2, x*sumw, x*x*sumw);
+}
+
+
+void HistoManager::FillProfiles(const Run* run)
+{
+  // depth profiles accumulated by the threads in their Run,
+  // copied once in the histograms of the master
+  for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+    G4int nbins = run->GetNbDepthBins(i);
+    for (G4int iphi=-1; iphi<fScorer->GetNbPhi(); iphi++) {
+      G4int id = fScorer->GetHistoId(i, iphi);
+      for (G4int bin=0; bin<nbins+2; bin++) {
+        SetBinContent(id, bin, run->GetDepthEntries(i, iphi, bin),
+                      run->GetDepthSumW(i, iphi, bin),
+                      run->GetDepthSumW2(i, iphi, bin));
+      }
+    }
+  }
+}
+
 
+void HistoManager::ActivateRecords(G4bool records)
+{
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  analysisManager->SetNtupleActivation(analysisManager->GetFirstNtupleId(),
+                                       records);
+}
+
+
+void HistoManager::FillRecord(G4int Z, G4int A, G4double depth,
+                              G4double energy, G4int parent,
+                              G4double primaryEnergy, G4double weight)
+{
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  G4int id = analysisManager->GetFirstNtupleId();
+  analysisManager->FillNtupleIColumn(id, 0, Z);
+  analysisManager->FillNtupleIColumn(id, 1, A);
+  analysisManager->FillNtupleDColumn(id, 2, depth/cm);
+  analysisManager->FillNtupleDColumn(id, 3, energy/MeV);
+  analysisManager->FillNtupleIColumn(id, 4, parent);
+  analysisManager->FillNtupleDColumn(id, 5, primaryEnergy/MeV);
+  analysisManager->FillNtupleDColumn(id, 6, weight);
+  analysisManager->AddNtupleRow(id);
+}
+
+
+G4String HistoManager::UnitSymbol(G4double value, const G4String& category)
+{
+  G4UnitsTable& table = G4UnitDefinition::GetUnitsTable();
+  for (size_t i=0; i<table.size(); i++) {
+    if (table[i]->GetName() != category) continue;
+    G4UnitsContainer& units = table[i]->GetUnitsList();
+    for (size_t j=0; j<units.size(); j++) {
+      if (units[j]->GetValue() == value) return units[j]->GetSymbol();
+    }
+  }
+  return "none";
 }
@@ -0,0 +1,70 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ImportanceBiasing.cc
+/// \brief Implementation of the ImportanceBiasing class
+
+#include "ImportanceBiasing.hh"
+#include "BiasingMessenger.hh"
+
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+
+
+ImportanceBiasing::ImportanceBiasing()
+: fRatio(1.), fBiasingMessenger(0)
+{
+  // the nucleons carry most of the production at depth
+  std::vector<G4String> names;
+  names.push_back("neutron");
+  names.push_back("proton");
+  SetParticles(names);
+
+  fBiasingMessenger = new BiasingMessenger(this);
+}
+
+
+ImportanceBiasing::~ImportanceBiasing()
+{
+  delete fBiasingMessenger;
+}
+
+
+void ImportanceBiasing::SetParticles(const std::vector<G4String>& names)
+{
+  fParticles.clear();
+  for (size_t i=0; i<names.size(); i++) {
+    G4ParticleDefinition* particle =
+      G4ParticleTable::GetParticleTable()->FindParticle(names[i]);
+    if (particle) {
+      fParticles.push_back(particle);
+    }
+    else {
+      G4cout << "\n--> warning from ImportanceBiasing::SetParticles : "
+             << names[i] << " not found" << G4endl;
+    }
+  }
+}
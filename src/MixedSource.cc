@@ -0,0 +1,217 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file MixedSource.cc
+/// \brief Implementation of the MixedSource class
+
+#include "MixedSource.hh"
+#include "MixedSourceMessenger.hh"
+#include "GCRSpectrum.hh"
+
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4IonTable.hh"
+#include "G4NistManager.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "Randomize.hh"
+
+#include <algorithm>
+#include <iomanip>
+
+
+MixedSource::MixedSource()
+: fPhi(660*MeV), fEmin(1*MeV), fEmax(100*GeV), fNbPoints(2000),
+  fTablesAreValid(false), fMixedMessenger(0)
+{
+  fMixedMessenger = new MixedSourceMessenger(this);
+}
+
+
+MixedSource::~MixedSource()
+{
+  delete fMixedMessenger;
+}
+
+
+void MixedSource::AddSpecies(const G4String& name)
+{
+  if (name != "proton" && name != "alpha") {
+    G4cout << "\n--> warning from MixedSource::AddSpecies : "
+           << name << " has no GCR spectrum (proton, alpha)" << G4endl;
+    return;
+  }
+  Species species;
+  species.fName     = name;
+  species.fZ        = (name == "alpha") ? 2 : 1;
+  species.fA        = (name == "alpha") ? 4 : 1;
+  species.fRatio    = 1.;
+  species.fParticle = 0;
+  species.fIntegral = 0.;
+  fSpecies.push_back(species);
+  fTablesAreValid = false;
+}
+
+
+void MixedSource::AddIon(G4int Z, G4int A, G4double ratio)
+{
+  if (Z < 3 || A < Z || ratio <= 0.) {
+    G4cout << "\n--> warning from MixedSource::AddIon : "
+           << "Z = " << Z << ", A = " << A << ", ratio = " << ratio
+           << " not accepted (Z > 2, ratio > 0)" << G4endl;
+    return;
+  }
+  Species species;
+  species.fName     = G4NistManager::Instance()->GetElementName(Z)
+                    + std::to_string(A);
+  species.fZ        = Z;
+  species.fA        = A;
+  species.fRatio    = ratio;
+  species.fParticle = 0;
+  species.fIntegral = 0.;
+  fSpecies.push_back(species);
+  fTablesAreValid = false;
+}
+
+
+void MixedSource::Clear()
+{
+  fSpecies.clear();
+  fCumulative.clear();
+  fTablesAreValid = false;
+}
+
+
+void MixedSource::SetPhi(G4double phi)
+{
+  fPhi = phi;
+  fTablesAreValid = false;
+}
+
+
+void MixedSource::SetEnergyRange(G4double emin, G4double emax)
+{
+  if (emin <= 0. || emax <= emin) {
+    G4cout << "\n--> warning from MixedSource::SetEnergyRange : "
+           << "wrong range " << G4BestUnit(emin, "Energy") << " - "
+           << G4BestUnit(emax, "Energy") << G4endl;
+    return;
+  }
+  fEmin = emin;
+  fEmax = emax;
+  fTablesAreValid = false;
+}
+
+
+void MixedSource::SetNbPoints(G4int n)
+{
+  fNbPoints = n;
+  fTablesAreValid = false;
+}
+
+
+G4double MixedSource::Flux(const Species& species, G4double ekin) const
+{
+  if (species.fZ == 1) return GCRSpectrum::ProtonFlux(ekin, fPhi);
+  if (species.fZ == 2) return GCRSpectrum::AlphaFlux(ekin, fPhi);
+
+  // alpha flux per nucleon, 4*J(4e), at e = ekin/A, per MeV of the ion
+  G4double A = species.fA;
+  return species.fRatio*4.*GCRSpectrum::AlphaFlux(4.*ekin/A, fPhi)/A;
+}
+
+
+void MixedSource::BuildTables()
+{
+  if (fTablesAreValid) return;
+
+  // log grid of the kinetic energy per nucleon, as GCRSpectrum
+  fCumulative.clear();
+  G4double total = 0.;
+  G4double dlog = std::log(fEmax/fEmin)/(fNbPoints - 1);
+  std::vector<G4double> energies(fNbPoints), flux(fNbPoints);
+  for (size_t i=0; i<fSpecies.size(); i++) {
+    Species& species = fSpecies[i];
+    if (species.fZ > 2)
+      species.fParticle = G4IonTable::GetIonTable()->GetIon(species.fZ, species.fA);
+    else
+      species.fParticle = G4ParticleTable::GetParticleTable()->FindParticle(species.fName);
+
+    for (G4int k=0; k<fNbPoints; k++) {
+      G4double e = (k == fNbPoints-1) ? fEmax : fEmin*std::exp(k*dlog);
+      energies[k] = e*species.fA;
+      flux[k] = Flux(species, energies[k]);
+    }
+    species.fSampler.SetTable(energies, flux);
+    species.fIntegral = species.fSampler.GetIntegral()/MeV;
+    total += species.fIntegral;
+    fCumulative.push_back(total);
+  }
+  fTablesAreValid = true;
+}
+
+
+G4double MixedSource::GetIntegralFlux() const
+{
+  return fCumulative.empty() ? 0. : fCumulative.back();
+}
+
+
+G4int MixedSource::Sample(G4double& energy) const
+{
+  G4double u = G4UniformRand()*fCumulative.back();
+  G4int i = std::upper_bound(fCumulative.begin(), fCumulative.end(), u)
+          - fCumulative.begin();
+  i = std::min(i, G4int(fSpecies.size()) - 1);
+  energy = fSpecies[i].fSampler.Sample();
+  return i;
+}
+
+
+G4int MixedSource::GetSpecies(const G4ParticleDefinition* particle) const
+{
+  for (size_t i=0; i<fSpecies.size(); i++) {
+    if (fSpecies[i].fParticle == particle) return i;
+  }
+  return -1;
+}
+
+
+void MixedSource::List()
+{
+  BuildTables();
+  G4cout << "\n Mixed GCR source, phi = " << G4BestUnit(fPhi, "Energy")
+         << ", " << G4BestUnit(fEmin, "Energy") << " - "
+         << G4BestUnit(fEmax, "Energy") << " per nucleon:" << G4endl;
+  G4double total = GetIntegralFlux();
+  for (size_t i=0; i<fSpecies.size(); i++) {
+    G4cout << "  " << std::setw(8) << fSpecies[i].fName
+           << " : " << std::setw(12) << fSpecies[i].fIntegral
+           << " particles/(m2 sr s)  (" << std::setw(8)
+           << ((total > 0.) ? 100.*fSpecies[i].fIntegral/total : 0.) << " %)"
+           << G4endl;
+  }
+}
@@ -0,0 +1,168 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file MixedSourceMessenger.cc
+/// \brief Implementation of the MixedSourceMessenger class
+
+#include "MixedSourceMessenger.hh"
+#include "MixedSource.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+
+MixedSourceMessenger::MixedSourceMessenger(MixedSource* mixed)
+:G4UImessenger(),
+ fMixed(mixed), fMixedDir(0), fAddCmd(0), fAddIonCmd(0), fClearCmd(0),
+ fPhiCmd(0), fRangeCmd(0), fPointsCmd(0), fListCmd(0)
+{
+  // executed by the master only: the tables are shared by the workers
+  G4bool broadcast = false;
+  fMixedDir = new G4UIdirectory("/source/mixed/", broadcast);
+  fMixedDir->SetGuidance("GCR species sampled in one run (/source/mode mixed)");
+
+  fAddCmd = new G4UIcmdWithAString("/source/mixed/add", this);
+  fAddCmd->SetGuidance("Add protons or alphas, with their force-field spectrum");
+  fAddCmd->SetParameterName("particle", false);
+  fAddCmd->SetCandidates("proton alpha");
+  fAddCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fAddIonCmd = new G4UIcommand("/source/mixed/addIon", this);
+  fAddIonCmd->SetGuidance("Add a heavier GCR ion, with the alpha spectrum per nucleon");
+  fAddIonCmd->SetGuidance("times its abundance ratio to helium at the same");
+  fAddIonCmd->SetGuidance("kinetic energy per nucleon.");
+  fAddIonCmd->SetGuidance("  Z, A, ratio");
+  //
+  G4UIparameter* ZPrm = new G4UIparameter("Z", 'i', false);
+  ZPrm->SetParameterRange("Z > 2");
+  fAddIonCmd->SetParameter(ZPrm);
+  //
+  G4UIparameter* APrm = new G4UIparameter("A", 'i', false);
+  APrm->SetParameterRange("A > 2");
+  fAddIonCmd->SetParameter(APrm);
+  //
+  G4UIparameter* ratioPrm = new G4UIparameter("ratio", 'd', false);
+  ratioPrm->SetParameterRange("ratio > 0.");
+  fAddIonCmd->SetParameter(ratioPrm);
+  //
+  fAddIonCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fClearCmd = new G4UIcmdWithoutParameter("/source/mixed/clear", this);
+  fClearCmd->SetGuidance("Remove all the species");
+  fClearCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPhiCmd = new G4UIcmdWithADoubleAndUnit("/source/mixed/phi", this);
+  fPhiCmd->SetGuidance("Set the solar modulation parameter");
+  fPhiCmd->SetParameterName("phi", false);
+  fPhiCmd->SetRange("phi >= 0.");
+  fPhiCmd->SetUnitCategory("Energy");
+  fPhiCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRangeCmd = new G4UIcommand("/source/mixed/energyRange", this);
+  fRangeCmd->SetGuidance("Set the kinetic energy range per nucleon");
+  fRangeCmd->SetGuidance("  Emin, Emax, unit");
+  //
+  G4UIparameter* eminPrm = new G4UIparameter("Emin", 'd', false);
+  eminPrm->SetParameterRange("Emin > 0.");
+  fRangeCmd->SetParameter(eminPrm);
+  //
+  G4UIparameter* emaxPrm = new G4UIparameter("Emax", 'd', false);
+  emaxPrm->SetParameterRange("Emax > 0.");
+  fRangeCmd->SetParameter(emaxPrm);
+  //
+  G4UIparameter* unitPrm = new G4UIparameter("unit", 's', true);
+  unitPrm->SetDefaultValue("MeV");
+  unitPrm->SetParameterCandidates(G4UIcommand::UnitsList("Energy"));
+  fRangeCmd->SetParameter(unitPrm);
+  //
+  fRangeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPointsCmd = new G4UIcmdWithAnInteger("/source/mixed/nbPoints", this);
+  fPointsCmd->SetGuidance("Set the number of points of the sampling tables");
+  fPointsCmd->SetParameterName("n", false);
+  fPointsCmd->SetRange("n > 1");
+  fPointsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fListCmd = new G4UIcmdWithoutParameter("/source/mixed/list", this);
+  fListCmd->SetGuidance("Print the species and their integral flux");
+  fListCmd->AvailableForStates(G4State_Idle);
+}
+
+
+MixedSourceMessenger::~MixedSourceMessenger()
+{
+  delete fAddCmd;
+  delete fAddIonCmd;
+  delete fClearCmd;
+  delete fPhiCmd;
+  delete fRangeCmd;
+  delete fPointsCmd;
+  delete fListCmd;
+  delete fMixedDir;
+}
+
+
+void MixedSourceMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fAddCmd)
+   { fMixed->AddSpecies(newValue);}
+
+  if (command == fAddIonCmd)
+   {
+     G4int Z, A;
+     G4double ratio;
+     std::istringstream is(newValue);
+     is >> Z >> A >> ratio;
+     fMixed->AddIon(Z, A, ratio);
+   }
+
+  if (command == fClearCmd)
+   { fMixed->Clear();}
+
+  if (command == fPhiCmd)
+   { fMixed->SetPhi(fPhiCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fRangeCmd)
+   {
+     G4double emin, emax;
+     G4String unit;
+     std::istringstream is(newValue);
+     is >> emin >> emax >> unit;
+     G4double u = G4UIcommand::ValueOf(unit);
+     fMixed->SetEnergyRange(emin*u, emax*u);
+   }
+
+  if (command == fPointsCmd)
+   { fMixed->SetNbPoints(fPointsCmd->GetNewIntValue(newValue));}
+
+  if (command == fListCmd)
+   { fMixed->List();}
+}
@@ -0,0 +1,191 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NuclideScorer.cc
+/// \brief Implementation of the NuclideScorer class
+
+#include "NuclideScorer.hh"
+#include "ScoringMessenger.hh"
+
+#include "G4NistManager.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cmath>
+#include <iomanip>
+
+
+NuclideScorer::NuclideScorer()
+: fNuclideIndex((kMaxZ+1)*(kMaxA+1), -1), fMaxDepth(8*m),
+  fRecords(false), fWithActivity(false), fExposureTime(0.), fIntensity(0.), fGeometryFactor(0.),
+  fResponseEmin(1*MeV), fResponseEmax(100*GeV), fNbResponsePoints(0), fScoringMessenger(0)
+{
+  // Default radionuclides - histogram ids 0 to 8
+  AddNuclide(13, 26);   //Al26
+  AddNuclide(25, 54);   //Mn54
+  AddNuclide(27, 57);   //Co57
+  AddNuclide(11, 22);   //Na22
+  AddNuclide(27, 60);   //Co60
+  AddNuclide(22, 44);   //Ti44
+  AddNuclide(20, 41);   //Ca41
+  AddNuclide(17, 36);   //Cl36
+  AddNuclide( 4, 10);   //Be10
+
+  // their activity histograms - ids 9 to 17; afterwards each histogram
+  // is followed by its activity histogram
+  for (G4int i=0; i<GetNbNuclides(); i++) {
+    fNuclides[i].fActivityIds.push_back(fHistos.size());
+    fHistos.push_back(Histo{i, -1, true});
+  }
+  fWithActivity = true;
+
+  fScoringMessenger = new ScoringMessenger(this);
+}
+
+
+NuclideScorer::~NuclideScorer()
+{
+  delete fScoringMessenger;
+}
+
+
+G4int NuclideScorer::AddNuclide(G4int Z, G4int A)
+{
+  if (Z <= 0 || Z > kMaxZ || A < Z || A > kMaxA) {
+    G4cout << "\n--> warning from NuclideScorer::AddNuclide : "
+           << "Z = " << Z << ", A = " << A << " out of range" << G4endl;
+    return -1;
+  }
+
+  G4int i = GetNuclide(Z, A);
+  if (i >= 0) {
+    G4cout << "\n--> warning from NuclideScorer::AddNuclide : "
+           << fNuclides[i].fName << " is already scored" << G4endl;
+    return -1;
+  }
+
+  Nuclide nuclide;
+  nuclide.fZ = Z;
+  nuclide.fA = A;
+  nuclide.fName = G4NistManager::Instance()->GetElementName(Z)
+                + std::to_string(A);
+
+  i = fNuclides.size();
+  fNuclides.push_back(nuclide);
+  fNuclideIndex[Z*(kMaxA+1) + A] = i;
+
+  // histograms: not reweighted, then one per phi value
+  for (G4int iphi=-1; iphi<GetNbPhi(); iphi++) AddHistos(i, iphi);
+  return i;
+}
+
+
+G4int NuclideScorer::AddPhi(G4double phi)
+{
+  for (size_t k=0; k<fPhiValues.size(); k++) {
+    if (fPhiValues[k] == phi) {
+      G4cout << "\n--> warning from NuclideScorer::AddPhi : "
+             << G4BestUnit(phi, "Energy") << " is already in the list" << G4endl;
+      return -1;
+    }
+  }
+
+  G4int iphi = fPhiValues.size();
+  fPhiValues.push_back(phi);
+  for (G4int i=0; i<GetNbNuclides(); i++) AddHistos(i, iphi);
+  return iphi;
+}
+
+
+void NuclideScorer::SetResponseGrid(G4double emin, G4double emax, G4int nbPoints)
+{
+  if (nbPoints > 0 && (emin <= 0. || emax < emin || (nbPoints > 1 && emax == emin))) {
+    G4cout << "\n--> warning from NuclideScorer::SetResponseGrid : "
+           << "wrong range " << G4BestUnit(emin, "Energy") << " - "
+           << G4BestUnit(emax, "Energy") << G4endl;
+    return;
+  }
+  fResponseEmin = emin;
+  fResponseEmax = emax;
+  fNbResponsePoints = nbPoints;
+}
+
+
+G4double NuclideScorer::GetResponseEnergy(G4int point) const
+{
+  if (fNbResponsePoints == 1 || point == 0) return fResponseEmin;
+  if (point == fNbResponsePoints-1) return fResponseEmax;
+  return fResponseEmin*std::pow(fResponseEmax/fResponseEmin,
+                                G4double(point)/(fNbResponsePoints - 1));
+}
+
+
+G4int NuclideScorer::GetResponsePoint(G4double energy) const
+{
+  if (fNbResponsePoints == 0 || energy <= 0.) return -1;
+  G4int point = 0;
+  if (fNbResponsePoints > 1) {
+    G4double x = std::log(energy/fResponseEmin)/std::log(fResponseEmax/fResponseEmin);
+    point = G4int(std::floor(x*(fNbResponsePoints - 1) + 0.5));
+  }
+  if (point < 0 || point >= fNbResponsePoints) return -1;
+  G4double e = GetResponseEnergy(point);
+  return (std::abs(energy - e) <= 1.e-9*e) ? point : -1;
+}
+
+
+void NuclideScorer::AddHistos(G4int i, G4int iphi)
+{
+  fNuclides[i].fHistoIds.push_back(fHistos.size());
+  fHistos.push_back(Histo{i, iphi, false});
+  if (!fWithActivity) return;
+  fNuclides[i].fActivityIds.push_back(fHistos.size());
+  fHistos.push_back(Histo{i, iphi, true});
+}
+
+
+G4String NuclideScorer::GetHistoTitle(G4int id) const
+{
+  G4String title = fNuclides[fHistos[id].fNuclide].fName
+                 + (fHistos[id].fActivity ? " activity (dpm/kg)" : " number");
+  G4int iphi = fHistos[id].fPhi;
+  if (iphi >= 0) {
+    title += " - phi = " + std::to_string(G4int(fPhiValues[iphi]/MeV + 0.5))
+           + " MeV";
+  }
+  return title;
+}
+
+
+void NuclideScorer::ListNuclides() const
+{
+  G4cout << "\n Scored radionuclides (max depth "
+         << G4BestUnit(fMaxDepth, "Length") << "):" << G4endl;
+  for (G4int id=0; id<GetNbHistos(); id++) {
+    G4cout << "  histo " << std::setw(3) << id << " : " << GetHistoTitle(id)
+           << G4endl;
+  }
+}
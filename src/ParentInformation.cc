@@ -0,0 +1,51 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ParentInformation.cc
+/// \brief Implementation of the ParentInformation class
+
+#include "ParentInformation.hh"
+
+#include "G4ParticleDefinition.hh"
+#include "G4UnitsTable.hh"
+
+
+ParentInformation::ParentInformation(const G4ParticleDefinition* parent,
+                                     G4double energy)
+: G4VUserTrackInformation("ParentInformation"),
+  fParent(parent), fEnergy(energy)
+{}
+
+
+ParentInformation::~ParentInformation()
+{}
+
+
+void ParentInformation::Print() const
+{
+  G4cout << " parent " << fParent->GetParticleName() << " of "
+         << G4BestUnit(fEnergy, "Energy") << G4endl;
+}
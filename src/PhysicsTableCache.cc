@@ -0,0 +1,197 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhysicsTableCache.cc
+/// \brief Implementation of the PhysicsTableCache class
+
+#include "PhysicsTableCache.hh"
+#include "PhysicsTableCacheMessenger.hh"
+
+#include "G4VUserPhysicsList.hh"
+#include "G4Material.hh"
+#include "G4Element.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4RegionStore.hh"
+#include "G4Region.hh"
+#include "G4ProductionCuts.hh"
+
+#include <cstdint>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <sys/stat.h>
+
+
+PhysicsTableCache::PhysicsTableCache(G4VUserPhysicsList* physicsList,
+                                     const G4String& physicsListName)
+: G4VStateDependent(),
+  fPhysicsList(physicsList), fPhysicsListName(physicsListName), fDirectory(""),
+  fInitializing(false), fBuilding(false), fReported(false), fKey(""),
+  fBuiltKey(""), fTableDir(""), fRetrieving(false), fCacheMessenger(0)
+{
+  fCacheMessenger = new PhysicsTableCacheMessenger(this);
+}
+
+
+PhysicsTableCache::~PhysicsTableCache()
+{
+  delete fCacheMessenger;
+}
+
+
+G4bool PhysicsTableCache::Notify(G4ApplicationState previous,
+                                 G4ApplicationState requested)
+{
+  // geometry and physics construction
+  if (previous == G4State_PreInit && requested == G4State_Init) {
+    fInitializing = true;
+    fTimer.Start();
+  }
+
+  // before a run: a geometry reinitialization, then the physics tables,
+  // rebuilt by Geant4 only when the materials or the cuts have changed.
+  // The last Idle -> Init before the geometry is closed decides
+  if (previous == G4State_Idle && requested == G4State_Init) {
+    if (fRetrieving) fPhysicsList->ResetPhysicsTableRetrieved();
+    fRetrieving = false;
+    fKey        = ComputeKey();
+    fBuilding   = (fKey != fBuiltKey);
+    fTableDir   = "";
+    if (fBuilding && fDirectory != "") {
+      fTableDir = fDirectory + "/" + fKey;
+      std::ifstream stored(fTableDir + "/couple.dat");
+      if (stored) {
+        fPhysicsList->SetPhysicsTableRetrieved(fTableDir);
+        fRetrieving = true;
+      }
+    }
+    fTimer.Start();
+  }
+
+  if (previous == G4State_Init && requested == G4State_Idle) {
+    fTimer.Stop();
+    if (fInitializing) {
+      G4cout << "\n Startup : geometry and physics construction "
+             << fTimer.GetRealElapsed() << " s" << G4endl;
+      fInitializing = false;
+    }
+  }
+
+  // the tables are built, or retrieved, when the geometry is closed
+  if (previous == G4State_Idle && requested == G4State_GeomClosed
+      && fBuilding) {
+    if (!fReported) {
+      PrintElements();
+      G4cout << "\n Startup : physics tables " << fTimer.GetRealElapsed()
+             << " s" << G4endl;
+      fReported = true;
+    }
+    if (fRetrieving) {
+      G4cout << "   physics tables retrieved from " << fTableDir << G4endl;
+      fPhysicsList->ResetPhysicsTableRetrieved();
+      fRetrieving = false;
+    }
+    else if (fTableDir != "") {
+      mkdir(fDirectory.c_str(), 0755);
+      mkdir(fTableDir.c_str(), 0755);
+      if (fPhysicsList->StorePhysicsTable(fTableDir))
+        G4cout << "   physics tables stored in " << fTableDir << G4endl;
+      else
+        G4cout << "\n--> warning from PhysicsTableCache::Notify : "
+               << "cannot store the physics tables in " << fTableDir << G4endl;
+    }
+    fBuiltKey = fKey;
+    fBuilding = false;
+  }
+  return true;
+}
+
+
+G4String PhysicsTableCache::ComputeKey() const
+{
+  // physics list, composition of every material, materials of the
+  // geometry and production cuts of every region, hashed with FNV-1a
+  std::ostringstream os;
+  os.precision(12);
+  os << fPhysicsListName;
+  const G4MaterialTable* materials = G4Material::GetMaterialTable();
+  for (size_t i=0; i<materials->size(); i++) {
+    const G4Material* material = (*materials)[i];
+    os << " " << material->GetName() << " " << material->GetDensity();
+    const G4double* fractions = material->GetFractionVector();
+    for (size_t j=0; j<material->GetNumberOfElements(); j++) {
+      os << " " << material->GetElement(j)->GetName() << " " << fractions[j];
+    }
+  }
+  std::set<G4String> used;
+  G4LogicalVolumeStore* volumes = G4LogicalVolumeStore::GetInstance();
+  for (size_t i=0; i<volumes->size(); i++) {
+    if ((*volumes)[i]->GetMaterial())
+      used.insert((*volumes)[i]->GetMaterial()->GetName());
+  }
+  for (std::set<G4String>::const_iterator it = used.begin(); it != used.end(); ++it)
+    os << " " << *it;
+  G4RegionStore* regions = G4RegionStore::GetInstance();
+  for (size_t i=0; i<regions->size(); i++) {
+    const G4ProductionCuts* cuts = (*regions)[i]->GetProductionCuts();
+    os << " " << (*regions)[i]->GetName();
+    for (G4int k=0; cuts && k<4; k++) os << " " << cuts->GetProductionCut(k);
+  }
+
+  std::uint64_t hash = UINT64_C(14695981039346656037);
+  std::string key = os.str();
+  for (size_t i=0; i<key.size(); i++) {
+    hash ^= static_cast<unsigned char>(key[i]);
+    hash *= UINT64_C(1099511628211);
+  }
+  std::ostringstream name;
+  name << fPhysicsListName << "_" << std::hex << hash;
+  return name.str();
+}
+
+
+void PhysicsTableCache::PrintElements() const
+{
+  // the neutron HP data are read for every element of the element table:
+  // elements that are not in the geometry only cost startup time
+  std::set<const G4Element*> used;
+  G4LogicalVolumeStore* volumes = G4LogicalVolumeStore::GetInstance();
+  for (size_t i=0; i<volumes->size(); i++) {
+    const G4Material* material = (*volumes)[i]->GetMaterial();
+    if (!material) continue;
+    for (size_t j=0; j<material->GetNumberOfElements(); j++)
+      used.insert(material->GetElement(j));
+  }
+  const G4ElementTable* elements = G4Element::GetElementTable();
+  G4cout << "\n Startup : physics data for " << elements->size()
+         << " elements, " << used.size() << " in the geometry" << G4endl;
+  for (size_t i=0; i<elements->size(); i++) {
+    if (used.count((*elements)[i])) continue;
+    G4cout << "\n--> warning from PhysicsTableCache : element "
+           << (*elements)[i]->GetName() << " is not in the geometry" << G4endl;
+  }
+}
@@ -0,0 +1,68 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhysicsTableCacheMessenger.cc
+/// \brief Implementation of the PhysicsTableCacheMessenger class
+
+#include "PhysicsTableCacheMessenger.hh"
+#include "PhysicsTableCache.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+
+
+PhysicsTableCacheMessenger::PhysicsTableCacheMessenger(PhysicsTableCache* cache)
+:G4UImessenger(),
+ fCache(cache), fPhysDir(0), fCacheCmd(0)
+{
+  G4bool broadcast = false;
+  fPhysDir = new G4UIdirectory("/testhadr/phys/", broadcast);
+  fPhysDir->SetGuidance("physics list commands");
+
+  fCacheCmd = new G4UIcmdWithAString("/testhadr/phys/tableCache", this);
+  fCacheCmd->SetGuidance("Directory of the cached physics tables (\"\": no cache).");
+  fCacheCmd->SetGuidance("The tables built for a run are stored in a subdirectory");
+  fCacheCmd->SetGuidance("keyed by the physics list, materials and cuts, and");
+  fCacheCmd->SetGuidance("retrieved by the next jobs with the same key.");
+  fCacheCmd->SetParameterName("dir", true);
+  fCacheCmd->SetDefaultValue("");
+  fCacheCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+
+PhysicsTableCacheMessenger::~PhysicsTableCacheMessenger()
+{
+  delete fCacheCmd;
+  delete fPhysDir;
+}
+
+
+void PhysicsTableCacheMessenger::SetNewValue(G4UIcommand* command,
+                                             G4String newValue)
+{
+  if (command == fCacheCmd)
+   { fCache->SetDirectory(newValue);}
+}
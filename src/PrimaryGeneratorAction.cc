@@ -29,8 +29,20 @@
 /// \brief Implementation of the PrimaryGeneratorAction class
 
 #include "PrimaryGeneratorAction.hh"
+#include "PrimaryGeneratorMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "GCRSpectrum.hh"
+#include "SCRSpectrum.hh"
+#include "NuclideScorer.hh"
+#include "SourceSpectrum.hh"
+#include "MixedSource.hh"
+#include "Profiler.hh"
+#include "Run.hh"
 
 #include "G4Event.hh"
+#include "G4RunManager.hh"
+#include "G4PrimaryVertex.hh"
+#include "G4PrimaryParticle.hh"
 #include "G4ParticleTable.hh"
 #include "G4ParticleDefinition.hh"
 #include "G4PhysicalConstants.hh"
@@ -38,24 +50,131 @@
 #include "Randomize.hh"
 
 
-PrimaryGeneratorAction::PrimaryGeneratorAction()
-: G4VUserPrimaryGeneratorAction(),fParticleGun(0)
+PrimaryGeneratorAction::PrimaryGeneratorAction(DetectorConstruction* det,
+                                               NuclideScorer* scorer,
+                                               SourceSpectrum* spectrum,
+                                               MixedSource* mixed,
+                                               Profiler* profiler)
+: G4VUserPrimaryGeneratorAction(), fDetector(det), fScorer(scorer),
+  fSpectrum(spectrum), fMixed(mixed), fProfiler(profiler),
+  fParticleGun(0),
+  fSourceMode("gps"), fPositionMode("gps"), fGCRSpectrum(0), fSCRSpectrum(0),
+  fPrimaryMessenger(0)
 {
   fParticleGun = new G4GeneralParticleSource();
 
   G4ParticleDefinition* particle = G4ParticleTable::GetParticleTable()->FindParticle("proton");
   fParticleGun->SetParticleDefinition(particle);
+
+  fGCRSpectrum = new GCRSpectrum();
+  fSCRSpectrum = new SCRSpectrum();
+  fPrimaryMessenger = new PrimaryGeneratorMessenger(this);
 }
 
 
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
+  delete fPrimaryMessenger;
+  delete fGCRSpectrum;
+  delete fSCRSpectrum;
   delete fParticleGun;
 }
 
 
+void PrimaryGeneratorAction::SetSourceMode(const G4String& mode)
+{
+  fSourceMode = mode;
+}
+
+
+void PrimaryGeneratorAction::SetPositionMode(const G4String& mode)
+{
+  fPositionMode = mode;
+}
+
+
+G4bool PrimaryGeneratorAction::IsSurfaceSource() const
+{
+  return fPositionMode == "surface" || fDetector->IsSurfaceSource();
+}
+
+
 void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 {
+  std::uint64_t ticks = fProfiler->IsActive() ? Profiler::Ticks() : 0;
+
   // G4cout << "Particles energy: " << fParticleGun->GetParticleEnergy() << G4endl;
   fParticleGun->GeneratePrimaryVertex(anEvent);
+
+  // position and direction from the GPS, particle and energy from the
+  // analytic spectrum (the GPS data are shared by the threads: they are
+  // not modified here)
+  if (fSourceMode == "gcr") {
+    G4PrimaryParticle* primary = anEvent->GetPrimaryVertex()->GetPrimary();
+    primary->SetParticleDefinition(fGCRSpectrum->GetParticle());
+    primary->SetKineticEnergy(fGCRSpectrum->Sample());
+  }
+  if (fSourceMode == "scr") {
+    G4PrimaryParticle* primary = anEvent->GetPrimaryVertex()->GetPrimary();
+    primary->SetParticleDefinition(fSCRSpectrum->GetParticle());
+    primary->SetKineticEnergy(fSCRSpectrum->Sample());
+  }
+
+  // tabulated spectrum, shared by the threads
+  if (fSourceMode == "table" && !fSpectrum->IsEmpty()) {
+    anEvent->GetPrimaryVertex()->GetPrimary()->SetKineticEnergy(fSpectrum->Sample());
+  }
+
+  // several GCR species, in proportion to their integral flux
+  if (fSourceMode == "mixed" && !fMixed->IsEmpty()) {
+    G4double energy;
+    G4int species = fMixed->Sample(energy);
+    G4PrimaryParticle* primary = anEvent->GetPrimaryVertex()->GetPrimary();
+    primary->SetParticleDefinition(fMixed->GetParticle(species));
+    primary->SetKineticEnergy(energy);
+  }
+
+  // response matrix: the same number of events for every grid point
+  // (the event ids are given by the master, whatever the thread)
+  G4int nbPoints = fScorer->GetNbResponsePoints();
+  if (fSourceMode == "grid" && nbPoints > 0) {
+    G4int point = anEvent->GetEventID() % nbPoints;
+    anEvent->GetPrimaryVertex()->GetPrimary()
+           ->SetKineticEnergy(fScorer->GetResponseEnergy(point));
+  }
+
+  if (IsSurfaceSource()) SampleSurfaceVertex(anEvent);
+
+  if (fProfiler->IsActive()) {
+    Run* run = static_cast<Run*>(
+          G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+    run->ProfilePrimary(Profiler::Ticks() - ticks);
+  }
+}
+
+
+void PrimaryGeneratorAction::SampleSurfaceVertex(G4Event* anEvent)
+{
+  // entry point uniform on the sphere
+  G4double cosTheta = 2*G4UniformRand() - 1.;
+  G4double sinTheta = std::sqrt(1. - cosTheta*cosTheta);
+  G4double phi = twopi*G4UniformRand();
+  G4ThreeVector normal(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+
+  // isotropic flux through the surface: cos(alpha) = sqrt(u)
+  // with respect to the inward normal
+  G4double u = G4UniformRand();
+  G4double cosAlpha = std::sqrt(u);
+  G4double sinAlpha = std::sqrt(1. - u);
+  G4double psi = twopi*G4UniformRand();
+  G4ThreeVector e1 = normal.orthogonal().unit();
+  G4ThreeVector e2 = normal.cross(e1);
+  G4ThreeVector direction = -cosAlpha*normal
+                          + sinAlpha*(std::cos(psi)*e1 + std::sin(psi)*e2);
+
+  G4PrimaryVertex* vertex = anEvent->GetPrimaryVertex();
+  vertex->SetPosition(fDetector->GetRadius()*normal.x(),
+                      fDetector->GetRadius()*normal.y(),
+                      fDetector->GetRadius()*normal.z());
+  vertex->GetPrimary()->SetMomentumDirection(direction);
 }
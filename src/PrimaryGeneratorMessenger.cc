@@ -0,0 +1,248 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PrimaryGeneratorMessenger.cc
+/// \brief Implementation of the PrimaryGeneratorMessenger class
+
+#include "PrimaryGeneratorMessenger.hh"
+#include "PrimaryGeneratorAction.hh"
+#include "GCRSpectrum.hh"
+#include "SCRSpectrum.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4SystemOfUnits.hh"
+
+
+PrimaryGeneratorMessenger::PrimaryGeneratorMessenger(PrimaryGeneratorAction* prim)
+:G4UImessenger(),
+ fPrimary(prim), fSourceDir(0), fModeCmd(0), fPositionCmd(0), fGCRDir(0), fGCRParticleCmd(0),
+ fGCRPhiCmd(0), fGCRRangeCmd(0), fGCRPointsCmd(0), fSCRDir(0), fSCRParticleCmd(0),
+ fSCRR0Cmd(0), fSCRFluxCmd(0), fSCRRangeCmd(0)
+{
+  fSourceDir = new G4UIdirectory("/source/");
+  fSourceDir->SetGuidance("primary generator commands");
+
+  fModeCmd = new G4UIcmdWithAString("/source/mode", this);
+  fModeCmd->SetGuidance("Select the energy spectrum of the primaries:");
+  fModeCmd->SetGuidance("  gps : particle and energy from the /gps/ commands");
+  fModeCmd->SetGuidance("  gcr : analytic GCR spectrum (/source/gcr/)");
+  fModeCmd->SetGuidance("  scr : exponential-rigidity SCR spectrum (/source/scr/)");
+  fModeCmd->SetGuidance("  table: particle from the /gps/ commands, energy from the");
+  fModeCmd->SetGuidance("        spectrum of /source/spectrum/load");
+  fModeCmd->SetGuidance("  mixed: GCR species and energies of /source/mixed/");
+  fModeCmd->SetGuidance("  grid: particle from the /gps/ commands, energies of");
+  fModeCmd->SetGuidance("        the response matrix (/scoring/response/grid)");
+  fModeCmd->SetGuidance("Position and direction: see /source/position.");
+  fModeCmd->SetParameterName("mode", false);
+  fModeCmd->SetCandidates("gps gcr scr table mixed grid");
+  fModeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPositionCmd = new G4UIcmdWithAString("/source/position", this);
+  fPositionCmd->SetGuidance("Select the position and direction of the primaries:");
+  fPositionCmd->SetGuidance("  gps     : from the /gps/pos/ and /gps/ang/ commands");
+  fPositionCmd->SetGuidance("  surface : isotropic flux on the target, every primary");
+  fPositionCmd->SetGuidance("            enters the sphere with a cosine-law direction");
+  fPositionCmd->SetParameterName("position", false);
+  fPositionCmd->SetCandidates("gps surface");
+  fPositionCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fGCRDir = new G4UIdirectory("/source/gcr/");
+  fGCRDir->SetGuidance("force-field GCR spectrum");
+
+  fGCRParticleCmd = new G4UIcmdWithAString("/source/gcr/particle", this);
+  fGCRParticleCmd->SetGuidance("Select the GCR species");
+  fGCRParticleCmd->SetParameterName("particle", false);
+  fGCRParticleCmd->SetCandidates("proton alpha");
+  fGCRParticleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fGCRPhiCmd = new G4UIcmdWithADoubleAndUnit("/source/gcr/phi", this);
+  fGCRPhiCmd->SetGuidance("Set the solar modulation parameter");
+  fGCRPhiCmd->SetParameterName("phi", false);
+  fGCRPhiCmd->SetRange("phi >= 0.");
+  fGCRPhiCmd->SetUnitCategory("Energy");
+  fGCRPhiCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fGCRRangeCmd = new G4UIcommand("/source/gcr/energyRange", this);
+  fGCRRangeCmd->SetGuidance("Set the kinetic energy range of the primaries");
+  fGCRRangeCmd->SetGuidance("  Emin, Emax, unit");
+  //
+  G4UIparameter* eminPrm = new G4UIparameter("Emin", 'd', false);
+  eminPrm->SetParameterRange("Emin > 0.");
+  fGCRRangeCmd->SetParameter(eminPrm);
+  //
+  G4UIparameter* emaxPrm = new G4UIparameter("Emax", 'd', false);
+  emaxPrm->SetParameterRange("Emax > 0.");
+  fGCRRangeCmd->SetParameter(emaxPrm);
+  //
+  G4UIparameter* unitPrm = new G4UIparameter("unit", 's', true);
+  unitPrm->SetDefaultValue("MeV");
+  unitPrm->SetParameterCandidates(G4UIcommand::UnitsList("Energy"));
+  fGCRRangeCmd->SetParameter(unitPrm);
+  //
+  fGCRRangeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fGCRPointsCmd = new G4UIcmdWithAnInteger("/source/gcr/nbPoints", this);
+  fGCRPointsCmd->SetGuidance("Set the number of points of the sampling table");
+  fGCRPointsCmd->SetParameterName("n", false);
+  fGCRPointsCmd->SetRange("n > 1");
+  fGCRPointsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSCRDir = new G4UIdirectory("/source/scr/");
+  fSCRDir->SetGuidance("solar cosmic rays, exponential rigidity spectrum");
+
+  fSCRParticleCmd = new G4UIcmdWithAString("/source/scr/particle", this);
+  fSCRParticleCmd->SetGuidance("Select the SCR species");
+  fSCRParticleCmd->SetParameterName("particle", false);
+  fSCRParticleCmd->SetCandidates("proton alpha");
+  fSCRParticleCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSCRR0Cmd = new G4UIcmdWithADoubleAndUnit("/source/scr/R0", this);
+  fSCRR0Cmd->SetGuidance("Set the characteristic rigidity R0: J(>R) = J0*exp(-R/R0)");
+  fSCRR0Cmd->SetParameterName("R0", false);
+  fSCRR0Cmd->SetRange("R0 > 0.");
+  fSCRR0Cmd->SetUnitCategory("Electric potential");
+  fSCRR0Cmd->SetDefaultUnit("megavolt");
+  fSCRR0Cmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSCRFluxCmd = new G4UIcommand("/source/scr/flux", this);
+  fSCRFluxCmd->SetGuidance("Set the omnidirectional (4pi) integral flux, in");
+  fSCRFluxCmd->SetGuidance("particles/(cm2 s), above a kinetic energy");
+  fSCRFluxCmd->SetGuidance("  flux, E, unit (default 100 above 10 MeV)");
+  //
+  G4UIparameter* fluxPrm = new G4UIparameter("flux", 'd', false);
+  fluxPrm->SetParameterRange("flux > 0.");
+  fSCRFluxCmd->SetParameter(fluxPrm);
+  //
+  G4UIparameter* abovePrm = new G4UIparameter("E", 'd', true);
+  abovePrm->SetDefaultValue(10.);
+  abovePrm->SetParameterRange("E >= 0.");
+  fSCRFluxCmd->SetParameter(abovePrm);
+  //
+  G4UIparameter* eunitPrm = new G4UIparameter("unit", 's', true);
+  eunitPrm->SetDefaultValue("MeV");
+  eunitPrm->SetParameterCandidates(G4UIcommand::UnitsList("Energy"));
+  fSCRFluxCmd->SetParameter(eunitPrm);
+  //
+  fSCRFluxCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSCRRangeCmd = new G4UIcommand("/source/scr/energyRange", this);
+  fSCRRangeCmd->SetGuidance("Set the kinetic energy range of the primaries");
+  fSCRRangeCmd->SetGuidance("  Emin, Emax, unit");
+  //
+  G4UIparameter* sminPrm = new G4UIparameter("Emin", 'd', false);
+  sminPrm->SetParameterRange("Emin > 0.");
+  fSCRRangeCmd->SetParameter(sminPrm);
+  //
+  G4UIparameter* smaxPrm = new G4UIparameter("Emax", 'd', false);
+  smaxPrm->SetParameterRange("Emax > 0.");
+  fSCRRangeCmd->SetParameter(smaxPrm);
+  //
+  G4UIparameter* sunitPrm = new G4UIparameter("unit", 's', true);
+  sunitPrm->SetDefaultValue("MeV");
+  sunitPrm->SetParameterCandidates(G4UIcommand::UnitsList("Energy"));
+  fSCRRangeCmd->SetParameter(sunitPrm);
+  //
+  fSCRRangeCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+
+PrimaryGeneratorMessenger::~PrimaryGeneratorMessenger()
+{
+  delete fModeCmd;
+  delete fPositionCmd;
+  delete fGCRParticleCmd;
+  delete fGCRPhiCmd;
+  delete fGCRRangeCmd;
+  delete fGCRPointsCmd;
+  delete fGCRDir;
+  delete fSCRParticleCmd;
+  delete fSCRR0Cmd;
+  delete fSCRFluxCmd;
+  delete fSCRRangeCmd;
+  delete fSCRDir;
+  delete fSourceDir;
+}
+
+
+void PrimaryGeneratorMessenger::SetNewValue(G4UIcommand* command,
+                                            G4String newValue)
+{
+  if (command == fModeCmd)
+   { fPrimary->SetSourceMode(newValue);}
+
+  if (command == fPositionCmd)
+   { fPrimary->SetPositionMode(newValue);}
+
+  if (command == fGCRParticleCmd)
+   { fPrimary->GetGCRSpectrum()->SetParticle(newValue);}
+
+  if (command == fGCRPhiCmd)
+   { fPrimary->GetGCRSpectrum()->SetPhi(fGCRPhiCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fGCRRangeCmd)
+   {
+     G4double emin, emax;
+     G4String unit;
+     std::istringstream is(newValue);
+     is >> emin >> emax >> unit;
+     G4double u = G4UIcommand::ValueOf(unit);
+     fPrimary->GetGCRSpectrum()->SetEnergyRange(emin*u, emax*u);
+   }
+
+  if (command == fGCRPointsCmd)
+   { fPrimary->GetGCRSpectrum()->SetNbPoints(fGCRPointsCmd->GetNewIntValue(newValue));}
+
+  if (command == fSCRParticleCmd)
+   { fPrimary->GetSCRSpectrum()->SetParticle(newValue);}
+
+  if (command == fSCRR0Cmd)
+   { fPrimary->GetSCRSpectrum()->SetR0(fSCRR0Cmd->GetNewDoubleValue(newValue));}
+
+  if (command == fSCRFluxCmd)
+   {
+     G4double flux, above;
+     G4String unit;
+     std::istringstream is(newValue);
+     is >> flux >> above >> unit;
+     fPrimary->GetSCRSpectrum()->SetFlux(flux/(cm2*s));
+     fPrimary->GetSCRSpectrum()->SetFluxAbove(above*G4UIcommand::ValueOf(unit));
+   }
+
+  if (command == fSCRRangeCmd)
+   {
+     G4double emin, emax;
+     G4String unit;
+     std::istringstream is(newValue);
+     is >> emin >> emax >> unit;
+     G4double u = G4UIcommand::ValueOf(unit);
+     fPrimary->GetSCRSpectrum()->SetEnergyRange(emin*u, emax*u);
+   }
+}
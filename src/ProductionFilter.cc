@@ -0,0 +1,167 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ProductionFilter.cc
+/// \brief Implementation of the ProductionFilter class
+
+#include "ProductionFilter.hh"
+#include "FilterMessenger.hh"
+#include "NuclideScorer.hh"
+
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4LogicalVolumeStore.hh"
+#include "G4LogicalVolume.hh"
+#include "G4Material.hh"
+#include "G4NucleiProperties.hh"
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
+
+#include <algorithm>
+#include <cfloat>
+#include <iomanip>
+
+
+ProductionFilter::ProductionFilter()
+: fActive(false), fFilterMessenger(0)
+{
+  fFilterMessenger = new FilterMessenger(this);
+}
+
+
+ProductionFilter::~ProductionFilter()
+{
+  delete fFilterMessenger;
+}
+
+
+void ProductionFilter::SetThreshold(const G4String& particle, G4double energy)
+{
+  if (particle == "neutron") {
+    G4cout << "\n--> warning from ProductionFilter::SetThreshold : "
+           << "neutrons are never killed (thermal captures)" << G4endl;
+    return;
+  }
+  if (!G4ParticleTable::GetParticleTable()->FindParticle(particle)) {
+    G4cout << "\n--> warning from ProductionFilter::SetThreshold : "
+           << particle << " not found" << G4endl;
+    return;
+  }
+  fUserThresholds[particle] = energy;
+}
+
+
+G4double ProductionFilter::SeparationEnergy(G4int Z, G4int A)
+{
+  // lowest energy needed to remove a n, p, d, t, He3 or alpha
+  static const G4int nbLight = 6;
+  static const G4int zLight[nbLight] = {0, 1, 1, 1, 2, 2};
+  static const G4int aLight[nbLight] = {1, 1, 2, 3, 3, 4};
+
+  G4double mass = G4NucleiProperties::GetNuclearMass(A, Z);
+  G4double separation = DBL_MAX;
+  for (G4int k=0; k<nbLight; k++) {
+    G4int zr = Z - zLight[k], ar = A - aLight[k];
+    if (ar < 1 || zr < 0 || zr > ar) continue;
+    G4double q = G4NucleiProperties::GetNuclearMass(ar, zr)
+               + G4NucleiProperties::GetNuclearMass(aLight[k], zLight[k]) - mass;
+    separation = std::min(separation, q);
+  }
+  return std::max(separation, 0.);
+}
+
+
+void ProductionFilter::ComputeThresholds(const NuclideScorer* scorer)
+{
+  // photo- and electro-nuclear reactions only remove nucleons: the targets
+  // are the isotopes of the geometry heavier than a scored nuclide.
+  // A nuclide also reached by a neutron capture (Cl36, Ca41, Co60...) can
+  // come from the photo-neutrons of any isotope, eg. D(g,n) at 2.2 MeV
+  G4double emThreshold = DBL_MAX, neutronThreshold = DBL_MAX;
+  G4bool capture = false;
+  G4LogicalVolumeStore* store = G4LogicalVolumeStore::GetInstance();
+  for (size_t iv=0; iv<store->size(); iv++) {
+    const G4Material* material = (*store)[iv]->GetMaterial();
+    for (size_t ie=0; ie<material->GetNumberOfElements(); ie++) {
+      const G4Element* element = material->GetElement(ie);
+      for (size_t ii=0; ii<element->GetNumberOfIsotopes(); ii++) {
+        G4int Zt = element->GetIsotope(ii)->GetZ();
+        G4int At = element->GetIsotope(ii)->GetN();
+        G4bool target = false;
+        for (G4int i=0; i<scorer->GetNbNuclides() && !target; i++) {
+          G4int Z = scorer->GetZ(i), A = scorer->GetA(i);
+          target = (Z <= Zt && A < At && A - Z <= At - Zt);
+        }
+        if (target) emThreshold = std::min(emThreshold, SeparationEnergy(Zt, At));
+        for (G4int i=0; i<scorer->GetNbNuclides() && !capture; i++)
+          capture = (scorer->GetZ(i) == Zt && scorer->GetA(i) == At + 1);
+        if (At > 1) {
+          G4double sn = G4NucleiProperties::GetNuclearMass(At-1, Zt)
+                      + neutron_mass_c2
+                      - G4NucleiProperties::GetNuclearMass(At, Zt);
+          neutronThreshold = std::min(neutronThreshold, std::max(sn, 0.));
+        }
+      }
+    }
+  }
+  if (capture) emThreshold = std::min(emThreshold, neutronThreshold);
+
+  // an e+ annihilating in flight gives a photon of up to Ekin + 2 m c2
+  G4ParticleTable* table = G4ParticleTable::GetParticleTable();
+  std::map<G4String,G4double> thresholds;
+  thresholds["gamma"] = emThreshold;
+  thresholds["e-"]    = emThreshold;
+  thresholds["e+"]    = std::max(emThreshold - 2*electron_mass_c2, 0.);
+  const char* neutrinos[] = {"nu_e", "anti_nu_e", "nu_mu", "anti_nu_mu",
+                             "nu_tau", "anti_nu_tau"};
+  for (size_t k=0; k<6; k++) thresholds[neutrinos[k]] = DBL_MAX;
+
+  std::map<G4String,G4double>::const_iterator it;
+  for (it = fUserThresholds.begin(); it != fUserThresholds.end(); ++it)
+    thresholds[it->first] = it->second;
+
+  fThresholds.clear();
+  for (it = thresholds.begin(); it != thresholds.end(); ++it) {
+    const G4ParticleDefinition* particle = table->FindParticle(it->first);
+    if (particle && it->second > 0.)
+      fThresholds.push_back(std::make_pair(particle, it->second));
+  }
+}
+
+
+void ProductionFilter::PrintThresholds() const
+{
+  G4cout << "\n Tracks killed at birth below (neutrons are kept) :" << G4endl;
+  for (size_t i=0; i<fThresholds.size(); i++) {
+    G4cout << "  " << std::setw(12) << fThresholds[i].first->GetParticleName()
+           << " : ";
+    if (fThresholds[i].second == DBL_MAX) G4cout << "all";
+    else G4cout << G4BestUnit(fThresholds[i].second, "Energy");
+    G4cout << G4endl;
+  }
+  G4cout << "  and the tracks leaving the meteorite" << G4endl;
+}
@@ -0,0 +1,61 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Profiler.cc
+/// \brief Implementation of the Profiler class
+
+#include "Profiler.hh"
+#include "ProfilerMessenger.hh"
+
+
+Profiler::Profiler()
+: fActive(false), fJsonFile(""), fStartTicks(0), fTicksPerSecond(0.),
+  fProfilerMessenger(0)
+{
+  fProfilerMessenger = new ProfilerMessenger(this);
+}
+
+
+Profiler::~Profiler()
+{
+  delete fProfilerMessenger;
+}
+
+
+void Profiler::BeginOfRun()
+{
+  fStartTime  = std::chrono::steady_clock::now();
+  fStartTicks = Ticks();
+}
+
+
+void Profiler::EndOfRun()
+{
+  std::uint64_t ticks = Ticks() - fStartTicks;
+  std::chrono::duration<G4double> time =
+    std::chrono::steady_clock::now() - fStartTime;
+  if (time.count() > 0.) fTicksPerSecond = ticks/time.count();
+}
@@ -0,0 +1,77 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ProfilerMessenger.cc
+/// \brief Implementation of the ProfilerMessenger class
+
+#include "ProfilerMessenger.hh"
+#include "Profiler.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4UIcmdWithAString.hh"
+
+
+ProfilerMessenger::ProfilerMessenger(Profiler* profiler)
+:G4UImessenger(),
+ fProfiler(profiler), fProfileDir(0), fActiveCmd(0), fJsonCmd(0)
+{
+  G4bool broadcast = false;
+  fProfileDir = new G4UIdirectory("/testhadr/profile/", broadcast);
+  fProfileDir->SetGuidance("time spent per particle, process and volume");
+
+  fActiveCmd = new G4UIcmdWithABool("/testhadr/profile/activate", this);
+  fActiveCmd->SetGuidance("Time every step and the primary generation,");
+  fActiveCmd->SetGuidance("printed at the end of the run (default false).");
+  fActiveCmd->SetParameterName("flag", true);
+  fActiveCmd->SetDefaultValue(true);
+  fActiveCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fJsonCmd = new G4UIcmdWithAString("/testhadr/profile/json", this);
+  fJsonCmd->SetGuidance("Also write the profile in this JSON file");
+  fJsonCmd->SetGuidance("  (\"\": none, the default)");
+  fJsonCmd->SetParameterName("fileName", true);
+  fJsonCmd->SetDefaultValue("");
+  fJsonCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+
+ProfilerMessenger::~ProfilerMessenger()
+{
+  delete fActiveCmd;
+  delete fJsonCmd;
+  delete fProfileDir;
+}
+
+
+void ProfilerMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fActiveCmd)
+   { fProfiler->SetActive(fActiveCmd->GetNewBoolValue(newValue));}
+
+  if (command == fJsonCmd)
+   { fProfiler->SetJsonFile(newValue);}
+}
@@ -32,15 +32,45 @@
 #include "DetectorConstruction.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "HistoManager.hh"
+#include "NuclideScorer.hh"
+#include "Profiler.hh"
 
+#include "G4IonTable.hh"
+#include "G4Ions.hh"
+#include "G4ParticleTable.hh"
+#include "G4Step.hh"
+#include "G4LogicalVolume.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4ProcessTable.hh"
+#include "G4ProcTblElement.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
+#include "G4PhysicalConstants.hh"
 
+#include <algorithm>
+#include <fstream>
+#include <sys/resource.h>
 
-Run::Run(DetectorConstruction* det)
+
+Run::Run(DetectorConstruction* det, NuclideScorer* scorer)
 : G4Run(),
-  fDetector(det), fParticle(0), fEkin(0.)
+  fDetector(det), fScorer(scorer), fParticle(0), fEkin(0.), fSurfaceSource(false), fProcShift(64),
+  fParticleShift(64), fNbParticles(0), fNbLayers(0),
+  fNbSplit(0), fNbRoulette(0), fNbEscaped(0), fWallTime(0.),
+  fProfiler(0), fLastTicks(0), fPrimaryTicks(0.), fDepthSize(0)
 {
+  // room for 512 particle species before the first resize
+  ResizeParticleTable(10);
+
+  // shells and core
+  if (fDetector->GetNbShells() > 0) {
+    fNbLayers = fDetector->GetNbShells() + 1;
+    fShellSum.assign(fScorer->GetNbNuclides()*fNbLayers, 0.);
+    fShellSum2.assign(fShellSum.size(), 0.);
+  }
+
+  BookProfiles();
+
   fEnergyDeposit = fEnergyDeposit2 = 0.;
   fEnergyFlow    = fEnergyFlow2    = 0.;  
 }
@@ -57,35 +87,108 @@ void Run::SetPrimary(G4ParticleDefinition* particle, G4double energy)
 }
  
 
-void Run::CountProcesses(const G4VProcess* process) 
+void Run::SetSpecies(const std::vector<G4String>& names)
+{
+  fSpeciesNames = names;
+  fSpeciesN.assign(names.size(), 0);
+  fSpeciesSw.assign(names.size()*fDepthSize, 0.);
+  fSpeciesSw2.assign(names.size()*fDepthSize, 0.);
+}
+
+
+void Run::RegisterProcesses() 
 {
-  G4String procName = process->GetProcessName();
-  std::map<G4String,G4int>::iterator it = fProcCounter.find(procName);
-  if ( it == fProcCounter.end()) {
-    fProcCounter[procName] = 1;
+  // all the processes known to this thread, sorted by name
+  G4ProcTableVector* table = G4ProcessTable::GetProcessTable()->GetProcTableVector();
+  std::vector<std::pair<G4String,const G4VProcess*> > procs;
+  for (size_t i=0; i<table->size(); i++) {
+    G4VProcess* process = (*table)[i]->GetProcess();
+    procs.push_back(std::make_pair(process->GetProcessName(), process));
   }
-  else {
-    fProcCounter[procName]++; 
+  std::sort(procs.begin(), procs.end(),
+    [](const std::pair<G4String,const G4VProcess*>& a,
+       const std::pair<G4String,const G4VProcess*>& b)
+    { return a.first < b.first; });
+
+  // hash table at most half full
+  G4int nbits = 4;
+  while ((std::size_t(1) << nbits) < 2*procs.size()) nbits++;
+  fProcShift = 64 - nbits;
+  fProcSlots.assign(std::size_t(1) << nbits, ProcessSlot{0, -1});
+  fProcList.clear();
+
+  // processes with the same name share the same id
+  std::size_t mask = fProcSlots.size() - 1;
+  for (size_t i=0; i<procs.size(); i++) {
+    if (i == 0 || procs[i].first != procs[i-1].first)
+      fProcList.push_back(procs[i].second);
+    G4int id = fProcList.size() - 1;
+    std::size_t h = PointerHash(procs[i].second, fProcShift);
+    while (fProcSlots[h].fProcess) h = (h + 1) & mask;
+    fProcSlots[h].fProcess = procs[i].second;
+    fProcSlots[h].fId      = id;
   }
+  fProcCounter.assign(fProcList.size(), 0);
+  fProcTicks.assign(fProcList.size(), 0.);
 }
                   
 
-void Run::ParticleCount(G4String name, G4double Ekin)
+void Run::BookProfiles()
 {
-  std::map<G4String, ParticleData>::iterator it = fParticleDataMap1.find(name);
-  if ( it == fParticleDataMap1.end()) {
-    fParticleDataMap1[name] = ParticleData(1, Ekin, Ekin, Ekin);
+  // binning of the nuclide histograms (/analysis/h1/set); the reweighted
+  // histograms of a nuclide have the same one
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  G4int size = 0;
+  fDepthSize = 0;
+  fDepthOffsets.assign(fScorer->GetNbNuclides(), 0);
+  fProfiles.resize(fScorer->GetNbNuclides());
+  for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+    DepthAxis& axis = fProfiles[i];
+    axis.fNbins  = 0;
+    axis.fOffset = size;
+    fDepthOffsets[i] = fDepthSize;
+    axis.fEdges.clear();
+    G4int ih = fScorer->GetHistoId(i);
+    tools::histo::h1d* h1 = analysisManager->GetH1(ih, false);
+    if (!h1) continue;
+
+    // axis limits are stored in the histogram unit
+    G4double unit = analysisManager->GetH1Unit(ih);
+    axis.fNbins    = h1->axis().bins();
+    axis.fXmin     = h1->axis().lower_edge()*unit;
+    axis.fInvWidth = axis.fNbins
+                   / ((h1->axis().upper_edge() - h1->axis().lower_edge())*unit);
+    if (!h1->axis().is_fixed_binning()) {
+      for (G4int bin=0; bin<axis.fNbins; bin++)
+        axis.fEdges.push_back(h1->axis().bin_lower_edge(bin)*unit);
+      axis.fEdges.push_back(h1->axis().upper_edge()*unit);
+    }
+    size += (fScorer->GetNbPhi() + 1)*(axis.fNbins + 2);
+    fDepthSize += axis.fNbins + 2;
+  }
+  fProfileN.assign(size, 0);
+  fProfileSw.assign(size, 0.);
+  fProfileSw2.assign(size, 0.);
+
+  // response matrix, with the same binning
+  G4int nbPoints = fScorer->GetNbResponsePoints();
+  fResponseN.assign(nbPoints, 0);
+  fResponseSw.assign(nbPoints*fDepthSize, 0.);
+  fResponseSw2.assign(nbPoints*fDepthSize, 0.);
+}
+
+
+void Run::ResizeParticleTable(G4int nbits)
+{
+  std::vector<ParticleData> oldTable;
+  oldTable.swap(fParticleTable);
+  fParticleTable.assign(std::size_t(1) << nbits, ParticleData());
+  fParticleShift = 64 - nbits;
+  fNbParticles = 0;
+  for (size_t i=0; i<oldTable.size(); i++) {
+    if (oldTable[i].fParticle)
+      FindParticleData(oldTable[i].fParticle) = oldTable[i];
   }
-  else {
-    ParticleData& data = it->second;
-    data.fCount++;
-    data.fEmean += Ekin;
-    //update min max
-    G4double emin = data.fEmin;
-    if (Ekin < emin) data.fEmin = Ekin;
-    G4double emax = data.fEmax;
-    if (Ekin > emax) data.fEmax = Ekin; 
-  }   
 }
 
 
@@ -96,45 +199,148 @@ void Run::Merge(const G4Run* run)
   //primary particle info
   fParticle = localRun->fParticle;
   fEkin     = localRun->fEkin;
+  if (!localRun->fSourceIntensity.empty())
+    fSourceIntensity = localRun->fSourceIntensity;
+  fSurfaceSource = fSurfaceSource || localRun->fSurfaceSource;
       
-  //map: processes count
-  std::map<G4String,G4int>::const_iterator itp;
-  for ( itp = localRun->fProcCounter.begin();
-        itp != localRun->fProcCounter.end(); ++itp ) {
+  //processes count: same ids in all threads
+  G4bool sameIds = (fProcList.size() == localRun->fProcList.size());
+  for (size_t i=0; sameIds && i<fProcList.size(); i++) {
+    sameIds = (fProcList[i]->GetProcessName()
+               == localRun->fProcList[i]->GetProcessName());
+  }
+  for (size_t i=0; i<localRun->fProcCounter.size(); i++) {
+    if (sameIds) fProcCounter[i] += localRun->fProcCounter[i];
+    else if (localRun->fProcCounter[i] > 0) 
+      fOtherProcCounter[localRun->fProcList[i]->GetProcessName()]
+        += localRun->fProcCounter[i];
+  }
+  std::map<G4String,G4long>::const_iterator itp;
+  for ( itp = localRun->fOtherProcCounter.begin();
+        itp != localRun->fOtherProcCounter.end(); ++itp ) {
+    fOtherProcCounter[itp->first] += itp->second;
+  }
 
-    G4String procName = itp->first;
-    G4int localCount = itp->second;
-    if ( fProcCounter.find(procName) == fProcCounter.end()) {
-      fProcCounter[procName] = localCount;
-    }
-    else {
-      fProcCounter[procName] += localCount;
-    }  
+  //profiler
+  if (localRun->fProfiler) fProfiler = localRun->fProfiler;
+  for (size_t i=0; i<localRun->fProcTicks.size(); i++) {
+    if (sameIds) fProcTicks[i] += localRun->fProcTicks[i];
+    else if (localRun->fProcTicks[i] > 0.)
+      fOtherProcTicks[localRun->fProcList[i]->GetProcessName()]
+        += localRun->fProcTicks[i];
+  }
+  std::map<G4String,G4double>::const_iterator itk;
+  for ( itk = localRun->fOtherProcTicks.begin();
+        itk != localRun->fOtherProcTicks.end(); ++itk ) {
+    fOtherProcTicks[itk->first] += itk->second;
   }
+  std::map<const G4LogicalVolume*,VolumeCost>::const_iterator itv;
+  for ( itv = localRun->fVolumeCosts.begin();
+        itv != localRun->fVolumeCosts.end(); ++itv ) {
+    fVolumeCosts[itv->first].fSteps += itv->second.fSteps;
+    fVolumeCosts[itv->first].fTicks += itv->second.fTicks;
+  }
+  fPrimaryTicks += localRun->fPrimaryTicks;
   
-  //map: created particles count    
-  std::map<G4String,ParticleData>::const_iterator itc;
-  for (itc = localRun->fParticleDataMap1.begin(); 
-       itc != localRun->fParticleDataMap1.end(); ++itc) {
-    
-    G4String name = itc->first;
-    const ParticleData& localData = itc->second;   
-    if ( fParticleDataMap1.find(name) == fParticleDataMap1.end()) {
-      fParticleDataMap1[name]
-       = ParticleData(localData.fCount, 
-                      localData.fEmean, 
-                      localData.fEmin, 
-                      localData.fEmax);
-    }
-    else {
-      ParticleData& data = fParticleDataMap1[name];   
-      data.fCount += localData.fCount;
-      data.fEmean += localData.fEmean;
-      G4double emin = localData.fEmin;
-      if (emin < data.fEmin) data.fEmin = emin;
-      G4double emax = localData.fEmax;
-      if (emax > data.fEmax) data.fEmax = emax; 
-    }   
+  //created particles count
+  for (size_t i=0; i<localRun->fParticleTable.size(); i++) {
+    const ParticleData& localData = localRun->fParticleTable[i];
+    if (localData.fCount == 0 && localData.fKilled == 0
+        && localData.fSteps == 0) continue;
+    ParticleData& data = FindParticleData(localData.fParticle);
+    data.fKilled += localData.fKilled;
+    data.fSteps  += localData.fSteps;
+    data.fTicks  += localData.fTicks;
+    if (localData.fCount == 0) continue;
+    if (data.fCount == 0) {
+      data.fEmin = localData.fEmin;
+      data.fEmax = localData.fEmax;
+    }
+    data.fCount += localData.fCount;
+    data.fEsum  += localData.fEsum;
+    data.fEsum2 += localData.fEsum2;
+    if (localData.fEmin < data.fEmin) data.fEmin = localData.fEmin;
+    if (localData.fEmax > data.fEmax) data.fEmax = localData.fEmax;
+  }
+
+  //radionuclides per shell
+  for (size_t k=0; k<localRun->fShellSum.size(); k++) {
+    fShellSum[k]  += localRun->fShellSum[k];
+    fShellSum2[k] += localRun->fShellSum2[k];
+  }
+
+  //production channels: matched by process name and parent
+  for (size_t i=0; i<localRun->fChannels.size(); i++) {
+    const Channel& local = localRun->fChannels[i];
+    Channel* channel = 0;
+    for (size_t j=0; j<fChannels.size() && !channel; j++) {
+      if (fChannels[j].fProcessName == local.fProcessName
+          && fChannels[j].fParent == local.fParent) channel = &fChannels[j];
+    }
+    if (!channel)
+      channel = &AddChannel(local.fProcess, local.fProcessName, local.fParent);
+    for (size_t k=0; k<local.fSumW.size() && k<channel->fSumW.size(); k++) {
+      channel->fSumW[k]  += local.fSumW[k];
+      channel->fSumW2[k] += local.fSumW2[k];
+    }
+  }
+
+  //importance biasing
+  fNbSplit    += localRun->fNbSplit;
+  fNbRoulette += localRun->fNbRoulette;
+  fNbEscaped  += localRun->fNbEscaped;
+
+  //load balance: the segments of a checkpointed job add up
+  std::map<G4int,ThreadTime>::const_iterator itt;
+  for (itt = localRun->fThreadTimes.begin();
+       itt != localRun->fThreadTimes.end(); ++itt) {
+    fThreadTimes[itt->first].fEvents += itt->second.fEvents;
+    fThreadTimes[itt->first].fBusy   += itt->second.fBusy;
+  }
+  fWallTime += localRun->fWallTime;
+
+  //depth profiles: same binning in all threads
+  if (fProfileSw.size() == localRun->fProfileSw.size()) {
+    for (size_t k=0; k<fProfileSw.size(); k++) {
+      fProfileN[k]   += localRun->fProfileN[k];
+      fProfileSw[k]  += localRun->fProfileSw[k];
+      fProfileSw2[k] += localRun->fProfileSw2[k];
+    }
+  }
+  else {
+    G4cout << "\n--> warning from Run::Merge : "
+           << "depth profiles with different binning not merged" << G4endl;
+  }
+
+  //response matrix
+  if (fResponseSw.size() == localRun->fResponseSw.size()) {
+    for (size_t p=0; p<fResponseN.size(); p++)
+      fResponseN[p] += localRun->fResponseN[p];
+    for (size_t k=0; k<fResponseSw.size(); k++) {
+      fResponseSw[k]  += localRun->fResponseSw[k];
+      fResponseSw2[k] += localRun->fResponseSw2[k];
+    }
+  }
+  else {
+    G4cout << "\n--> warning from Run::Merge : "
+           << "response matrices of different size not merged" << G4endl;
+  }
+
+  //species of the mixed source
+  if (fSpeciesNames.empty() && !localRun->fSpeciesNames.empty())
+    SetSpecies(localRun->fSpeciesNames);
+  if (fSpeciesNames == localRun->fSpeciesNames
+      && fSpeciesSw.size() == localRun->fSpeciesSw.size()) {
+    for (size_t j=0; j<fSpeciesN.size(); j++)
+      fSpeciesN[j] += localRun->fSpeciesN[j];
+    for (size_t k=0; k<fSpeciesSw.size(); k++) {
+      fSpeciesSw[k]  += localRun->fSpeciesSw[k];
+      fSpeciesSw2[k] += localRun->fSpeciesSw2[k];
+    }
+  }
+  else {
+    G4cout << "\n--> warning from Run::Merge : "
+           << "different species of the mixed source not merged" << G4endl;
   }
 
   G4Run::Merge(run); 
@@ -151,22 +357,40 @@ void Run::EndOfRun()
   G4Material* material = fDetector->GetMaterial();
   G4double density = material->GetDensity();
    
-  G4String Particle = fParticle->GetParticleName();    
-  G4cout << "\n The run is " << numberOfEvent << " "<< Particle << " of "
-         << G4BestUnit(fEkin,"Energy") << " through " 
+  G4long nbSpecies = 0;
+  for (size_t j=0; j<fSpeciesN.size(); j++) nbSpecies += fSpeciesN[j];
+  if (nbSpecies > 0) {
+    G4cout << "\n The run is " << numberOfEvent << " primaries of the mixed source (";
+    for (size_t j=0; j<fSpeciesNames.size(); j++)
+      G4cout << (j ? " " : "") << fSpeciesNames[j];
+    G4cout << ")";
+  }
+  else {
+    G4String Particle = fParticle ? fParticle->GetParticleName() : G4String("?");
+    G4cout << "\n The run is " << numberOfEvent << " "<< Particle << " of "
+           << G4BestUnit(fEkin,"Energy");
+  }
+  G4cout << " through " 
          << G4BestUnit(fDetector->GetVolume(), "Volume") << " of "
          << material->GetName() << " (density: " 
          << G4BestUnit(density,"Volumic Mass") << ")" << G4endl;
 
   if (numberOfEvent == 0) { G4cout.precision(dfprec);   return;}
+
+  if (fSurfaceSource) PrintFluxNormalization();
              
   //frequency of processes
   G4cout << "\n Process calls frequency :" << G4endl;
+  std::map<G4String,G4long> procCounter = fOtherProcCounter;
+  for (size_t i=0; i<fProcCounter.size(); i++) {
+     if (fProcCounter[i] > 0)
+       procCounter[fProcList[i]->GetProcessName()] += fProcCounter[i];
+  }
   G4int index = 0;
-  std::map<G4String,G4int>::iterator it;    
-  for (it = fProcCounter.begin(); it != fProcCounter.end(); it++) {
+  std::map<G4String,G4long>::iterator it;    
+  for (it = procCounter.begin(); it != procCounter.end(); it++) {
      G4String procName = it->first;
-     G4int    count    = it->second;
+     G4long   count    = it->second;
      G4String space = " "; if (++index%3 == 0) space = "\n";
      G4cout << " " << std::setw(20) << procName << "="<< std::setw(7) << count
             << space;
@@ -177,20 +401,790 @@ void Run::EndOfRun()
   //particles count
   G4cout << "\n List of generated particles:" << G4endl;
      
-  std::map<G4String,ParticleData>::iterator itc;               
-  for (itc = fParticleDataMap1.begin(); itc != fParticleDataMap1.end(); itc++) { 
+  //sorted by name
+  std::map<G4String,const ParticleData*> particles;
+  for (size_t i=0; i<fParticleTable.size(); i++) {
+    const ParticleData& data = fParticleTable[i];
+    if (data.fCount > 0) particles[data.fParticle->GetParticleName()] = &data;
+  }
+
+  std::map<G4String,const ParticleData*>::iterator itc;               
+  for (itc = particles.begin(); itc != particles.end(); itc++) { 
     G4String name = itc->first;
-    ParticleData data = itc->second;
-    G4int count = data.fCount;
-    G4double eMean = data.fEmean/count;
+    const ParticleData& data = *(itc->second);
+    G4long count = data.fCount;
+    G4double eMean = data.fEsum/count;
+    G4double eRms2 = data.fEsum2/count - eMean*eMean;
+    G4double eRms = (eRms2 > 0.) ? std::sqrt(eRms2) : 0.;
     G4double eMin = data.fEmin;
     G4double eMax = data.fEmax;    
          
     G4cout << "  " << std::setw(13) << name << ": " << std::setw(7) << count
            << "  Emean = " << std::setw(wid) << G4BestUnit(eMean, "Energy")
+           << "  rms = " << std::setw(wid) << G4BestUnit(eRms, "Energy")
            << "\t( "  << G4BestUnit(eMin, "Energy")
            << " --> " << G4BestUnit(eMax, "Energy") 
            << ")" << G4endl;           
   }
-  
+
+  //production filter
+  std::map<G4String,G4long> killed;
+  for (size_t i=0; i<fParticleTable.size(); i++) {
+    const ParticleData& data = fParticleTable[i];
+    if (data.fKilled > 0) killed[data.fParticle->GetParticleName()] = data.fKilled;
+  }
+  if (!killed.empty() || fNbEscaped > 0) {
+    G4cout << "\n Tracks killed at birth:" << G4endl;
+    index = 0;
+    for (it = killed.begin(); it != killed.end(); it++) {
+      G4String space = " "; if (++index%3 == 0) space = "\n";
+      G4cout << " " << std::setw(20) << it->first << "=" << std::setw(7)
+             << it->second << space;
+    }
+    G4cout << "\n Tracks killed leaving the meteorite: " << fNbEscaped << G4endl;
+  }
+
+  //importance biasing
+  if (fNbSplit > 0 || fNbRoulette > 0) {
+    G4cout << "\n Importance biasing : " << fNbSplit
+           << " tracks added by splitting, " << fNbRoulette
+           << " killed by Russian roulette" << G4endl;
+  }
+
+  //production channels, per nuclide
+  if (!fChannels.empty()) {
+    G4cout << "\n Production channels of the radionuclides"
+           << " (creator process, parent: fraction) :" << G4endl;
+  }
+  for (G4int i=0; !fChannels.empty() && i<fScorer->GetNbNuclides(); i++) {
+    std::multimap<G4double,const Channel*> sorted;
+    G4double total = 0.;
+    for (size_t j=0; j<fChannels.size(); j++) {
+      G4double sum = 0.;
+      for (G4int b=0; b<kNbBands; b++) sum += fChannels[j].fSumW[i*kNbBands+b];
+      if (sum > 0.) sorted.insert(std::make_pair(sum, &fChannels[j]));
+      total += sum;
+    }
+    if (total <= 0.) continue;
+    G4cout << "  " << std::setw(8) << fScorer->GetName(i) << ":";
+    index = 0;
+    std::multimap<G4double,const Channel*>::reverse_iterator itr;
+    for (itr = sorted.rbegin(); itr != sorted.rend(); ++itr) {
+      const Channel* channel = itr->second;
+      G4String parent = channel->fParent ?
+                        channel->fParent->GetParticleName() : G4String("?");
+      if (index > 0 && index%3 == 0) G4cout << "\n" << std::setw(12) << " ";
+      G4cout << "  " << channel->fProcessName << ", " << parent << ": "
+             << std::setprecision(3) << 100*itr->first/total << " %";
+      index++;
+    }
+    G4cout << std::setprecision(prec) << G4endl;
+  }
+
+  PrintLoadBalance();
+  PrintPerformance();
+  if (fProfiler && fProfiler->IsActive()) {
+    PrintProfile();
+    if (fProfiler->GetJsonFile() != "") WriteProfileJson(fProfiler->GetJsonFile());
+  }
+
+  //activities from the depth histograms
+  ComputeActivities();
+
+  //radionuclides per shell, production channels
+  G4String fileName = G4AnalysisManager::Instance()->GetFileName();
+  if (fileName == "") fileName = "RadionuclidesProduction";
+  if (fNbLayers > 0) WriteShells(fileName + "_shells.txt");
+  if (!fChannels.empty()) WriteChannels(fileName + "_channels.txt");
+  if (!fResponseN.empty()) WriteResponse(fileName + "_response.bin");
+  if (nbSpecies > 0) {
+    PrintSpecies();
+    WriteSpecies(fileName + "_species.txt");
+  }
+
+  G4cout.precision(dfprec);
+}
+
+
+void Run::WriteParticle(std::ostream& out, const G4ParticleDefinition* particle)
+{
+  // ions by (Z, A, excitation energy), since they may not exist
+  // yet in the particle table when the checkpoint is read back
+  if (!particle) { out << " none"; return; }
+  if (particle->IsGeneralIon()) {
+    out << " ion " << particle->GetAtomicNumber()
+        << " " << particle->GetAtomicMass()
+        << " " << static_cast<const G4Ions*>(particle)->GetExcitationEnergy();
+  }
+  else out << " " << particle->GetParticleName();
+}
+
+
+const G4ParticleDefinition* Run::ReadParticle(std::istream& in)
+{
+  G4String name;
+  in >> name;
+  if (name == "none") return 0;
+  if (name == "ion") {
+    G4int Z, A; G4double E;
+    in >> Z >> A >> E;
+    return G4IonTable::GetIonTable()->GetIon(Z, A, E);
+  }
+  return G4ParticleTable::GetParticleTable()->FindParticle(name);
+}
+
+
+void Run::Save(std::ostream& out) const
+{
+  out.precision(17);
+  out << "events " << numberOfEvent << "\n";
+
+  // run condition and source intensities, for the activities of a merge
+  out << "primary";
+  WriteParticle(out, fParticle);
+  out << " " << fEkin << " " << fSurfaceSource << " " << fSourceIntensity.size();
+  for (size_t i=0; i<fSourceIntensity.size(); i++) out << " " << fSourceIntensity[i];
+  out << "\n";
+
+  std::map<G4String,G4long> procCounter = fOtherProcCounter;
+  for (size_t i=0; i<fProcCounter.size(); i++) {
+    if (fProcCounter[i] > 0)
+      procCounter[fProcList[i]->GetProcessName()] += fProcCounter[i];
+  }
+  out << "processes " << procCounter.size() << "\n";
+  std::map<G4String,G4long>::const_iterator it;
+  for (it = procCounter.begin(); it != procCounter.end(); ++it)
+    out << it->first << " " << it->second << "\n";
+
+  out << "particles " << fNbParticles << "\n";
+  for (size_t i=0; i<fParticleTable.size(); i++) {
+    const ParticleData& data = fParticleTable[i];
+    if (!data.fParticle) continue;
+    WriteParticle(out, data.fParticle);
+    out << " " << data.fCount << " " << data.fKilled << " " << data.fEsum
+        << " " << data.fEsum2 << " " << data.fEmin << " " << data.fEmax << "\n";
+  }
+
+  out << "shells " << fShellSum.size() << "\n";
+  for (size_t k=0; k<fShellSum.size(); k++)
+    out << fShellSum[k] << " " << fShellSum2[k] << "\n";
+
+  out << "channels " << fChannels.size() << " " << fScorer->GetNbNuclides() << "\n";
+  for (size_t j=0; j<fChannels.size(); j++) {
+    out << fChannels[j].fProcessName;
+    WriteParticle(out, fChannels[j].fParent);
+    for (size_t k=0; k<fChannels[j].fSumW.size(); k++)
+      out << " " << fChannels[j].fSumW[k] << " " << fChannels[j].fSumW2[k];
+    out << "\n";
+  }
+
+  out << "biasing " << fNbSplit << " " << fNbRoulette << " " << fNbEscaped << "\n";
+
+  out << "profiles " << fProfileSw.size() << "\n";
+  for (size_t k=0; k<fProfileSw.size(); k++)
+    out << fProfileN[k] << " " << fProfileSw[k] << " " << fProfileSw2[k] << "\n";
+
+  out << "response " << fResponseN.size() << " " << fDepthSize << "\n";
+  for (size_t p=0; p<fResponseN.size(); p++) out << fResponseN[p] << "\n";
+  for (size_t k=0; k<fResponseSw.size(); k++)
+    out << fResponseSw[k] << " " << fResponseSw2[k] << "\n";
+
+  out << "species " << fSpeciesNames.size();
+  for (size_t j=0; j<fSpeciesNames.size(); j++)
+    out << " " << fSpeciesNames[j] << " " << fSpeciesN[j];
+  out << "\n";
+  for (size_t k=0; k<fSpeciesSw.size(); k++)
+    out << fSpeciesSw[k] << " " << fSpeciesSw2[k] << "\n";
+}
+
+
+G4bool Run::Load(std::istream& in)
+{
+  G4String key;
+  size_t n;
+
+  in >> key >> numberOfEvent;
+
+  in >> key;
+  fParticle = const_cast<G4ParticleDefinition*>(ReadParticle(in));
+  in >> fEkin >> fSurfaceSource >> n;
+  fSourceIntensity.resize(n);
+  for (size_t i=0; i<n; i++) in >> fSourceIntensity[i];
+
+  in >> key >> n;
+  for (size_t i=0; i<n && in; i++) {
+    G4String name; G4long count;
+    in >> name >> count;
+    fOtherProcCounter[name] += count;
+  }
+
+  in >> key >> n;
+  for (size_t i=0; i<n && in; i++) {
+    const G4ParticleDefinition* particle = ReadParticle(in);
+    ParticleData saved;
+    in >> saved.fCount >> saved.fKilled >> saved.fEsum >> saved.fEsum2
+       >> saved.fEmin >> saved.fEmax;
+    if (!particle) return false;
+    ParticleData& data = FindParticleData(particle);
+    saved.fParticle = particle;
+    data = saved;
+  }
+
+  in >> key >> n;
+  if (n != fShellSum.size()) return false;
+  for (size_t k=0; k<n; k++) in >> fShellSum[k] >> fShellSum2[k];
+
+  G4int nbNuclides;
+  in >> key >> n >> nbNuclides;
+  if (nbNuclides != fScorer->GetNbNuclides()) return false;
+  for (size_t j=0; j<n && in; j++) {
+    G4String processName;
+    in >> processName;
+    Channel& channel = AddChannel(0, processName, ReadParticle(in));
+    for (size_t k=0; k<channel.fSumW.size(); k++)
+      in >> channel.fSumW[k] >> channel.fSumW2[k];
+  }
+
+  in >> key >> fNbSplit >> fNbRoulette >> fNbEscaped;
+
+  in >> key >> n;
+  if (n != fProfileSw.size()) return false;
+  for (size_t k=0; k<n; k++) in >> fProfileN[k] >> fProfileSw[k] >> fProfileSw2[k];
+
+  G4int size;
+  in >> key >> n >> size;
+  if (n != fResponseN.size() || size != fDepthSize) return false;
+  for (size_t p=0; p<n; p++) in >> fResponseN[p];
+  for (size_t k=0; k<fResponseSw.size(); k++) in >> fResponseSw[k] >> fResponseSw2[k];
+
+  in >> key >> n;
+  std::vector<G4String> names(n);
+  std::vector<G4long> counts(n);
+  for (size_t j=0; j<n && in; j++) in >> names[j] >> counts[j];
+  SetSpecies(names);
+  fSpeciesN = counts;
+  for (size_t k=0; k<fSpeciesSw.size(); k++) in >> fSpeciesSw[k] >> fSpeciesSw2[k];
+
+  return !in.fail();
+}
+
+
+void Run::WriteShells(const G4String& fileName) const
+{
+  std::ofstream file(fileName);
+  if (!file) {
+    G4cout << "\n--> warning from Run::WriteShells : cannot open "
+           << fileName << G4endl;
+    return;
+  }
+
+  // one line per shell, the core last; depths in cm, masses in kg
+  file << "# " << numberOfEvent << " primaries, radius "
+       << fDetector->GetRadius()/cm << " cm\n";
+  file << "# shell depthMin depthMax mass material";
+  for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+    file << " " << fScorer->GetName(i) << " " << fScorer->GetName(i) << "_err";
+  }
+  for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+    file << " " << fScorer->GetName(i) << "_dpm/kg "
+         << fScorer->GetName(i) << "_dpm/kg_err";
+  }
+  file << "\n";
+
+  G4double radius = fDetector->GetRadius();
+  file.precision(8);
+  for (G4int j=0; j<fNbLayers; j++) {
+    file << j
+         << " " << (radius - fDetector->GetShellRmax(j))/cm
+         << " " << (radius - fDetector->GetShellRmin(j))/cm
+         << " " << fDetector->GetShellMass(j)/kg
+         << " " << fDetector->GetShellMaterial(j)->GetName();
+    for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+      std::size_t k = i*fNbLayers + j;
+      file << " " << fShellSum[k] << " " << std::sqrt(fShellSum2[k]);
+    }
+    G4double mass = fDetector->GetShellMass(j)/kg;
+    for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+      std::size_t k = i*fNbLayers + j;
+      G4double norm = ActivityNorm(i, -1)/mass;
+      file << " " << fShellSum[k]*norm << " " << std::sqrt(fShellSum2[k])*norm;
+    }
+    file << "\n";
+  }
+
+  G4cout << "\n Radionuclides per shell written in " << fileName << G4endl;
+}
+
+
+void Run::PrintPerformance() const
+{
+  // one line, parsed by the benchmarks: every step is counted by a process
+  if (fWallTime <= 0.) return;
+  G4long steps = 0;
+  for (size_t i=0; i<fProcCounter.size(); i++) steps += fProcCounter[i];
+  std::map<G4String,G4long>::const_iterator it;
+  for (it = fOtherProcCounter.begin(); it != fOtherProcCounter.end(); ++it)
+    steps += it->second;
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+
+  G4cout << "\n Performance : events " << numberOfEvent
+         << " steps " << steps
+         << " wallTime " << fWallTime
+         << " events/s " << numberOfEvent/fWallTime
+         << " steps/s " << steps/fWallTime
+         << " peakRSS(MB) " << usage.ru_maxrss/1024.
+         << " threads " << std::max(std::size_t(1), fThreadTimes.size()) << G4endl;
+}
+
+
+void Run::PrintLoadBalance() const
+{
+  // idle time: waiting for events, mostly at the end of the run
+  if (fThreadTimes.empty() || fWallTime <= 0.) return;
+  G4double busyMax = 0., busySum = 0.;
+  G4cout << "\n Load balance (wall time " << fWallTime << " s) :" << G4endl;
+  G4cout << "   thread   events  busy (s)  idle (s)" << G4endl;
+  std::map<G4int,ThreadTime>::const_iterator it;
+  for (it = fThreadTimes.begin(); it != fThreadTimes.end(); ++it) {
+    G4double busy = it->second.fBusy;
+    G4cout << "  " << std::setw(7) << it->first
+           << "  " << std::setw(7) << it->second.fEvents
+           << "  " << std::setw(8) << busy
+           << "  " << std::setw(8) << std::max(fWallTime - busy, 0.) << G4endl;
+    busyMax = std::max(busyMax, busy);
+    busySum += busy;
+  }
+  G4double busyMean = busySum/fThreadTimes.size();
+  G4int prec = G4cout.precision(3);
+  G4cout << "   busy mean " << busyMean << " s, max " << busyMax
+         << " s : imbalance "
+         << 100*(busyMax - busyMean)/fWallTime << " % of the wall time"
+         << G4endl;
+  G4cout.precision(prec);
+}
+
+
+void Run::ProfileStep(const G4Step* step, std::uint64_t ticks)
+{
+  G4double dt = G4double(ticks - fLastTicks);
+  fLastTicks = ticks;
+
+  ParticleData& data = FindParticleData(step->GetTrack()->GetParticleDefinition());
+  data.fSteps++;
+  data.fTicks += dt;
+
+  const G4VProcess* process = step->GetPostStepPoint()->GetProcessDefinedStep();
+  G4int id = ProcessId(process);
+  if (id >= 0) fProcTicks[id] += dt;
+  else if (process) fOtherProcTicks[process->GetProcessName()] += dt;
+
+  VolumeCost& cost = fVolumeCosts[step->GetPreStepPoint()->GetTouchableHandle()
+                                  ->GetVolume()->GetLogicalVolume()];
+  cost.fSteps++;
+  cost.fTicks += dt;
+}
+
+
+void Run::PrintProfile() const
+{
+  // the most expensive entries of each category, in seconds of all
+  // threads and in fraction of the profiled time
+  std::multimap<G4double,G4String> particles, processes, volumes;
+  G4double total = 0.;
+  for (size_t i=0; i<fParticleTable.size(); i++) {
+    const ParticleData& data = fParticleTable[i];
+    if (data.fSteps == 0) continue;
+    particles.insert(std::make_pair(data.fTicks, data.fParticle->GetParticleName()
+                     + " (" + std::to_string(data.fSteps) + " steps)"));
+    total += data.fTicks;
+  }
+  std::map<G4String,G4double> procTicks = fOtherProcTicks;
+  for (size_t i=0; i<fProcTicks.size(); i++) {
+    if (fProcTicks[i] > 0.) procTicks[fProcList[i]->GetProcessName()] += fProcTicks[i];
+  }
+  std::map<G4String,G4double>::const_iterator itp;
+  for (itp = procTicks.begin(); itp != procTicks.end(); ++itp)
+    processes.insert(std::make_pair(itp->second, itp->first));
+  std::map<G4String,G4double> volTicks;
+  std::map<const G4LogicalVolume*,VolumeCost>::const_iterator itv;
+  for (itv = fVolumeCosts.begin(); itv != fVolumeCosts.end(); ++itv)
+    volTicks[itv->first->GetName()] += itv->second.fTicks;
+  for (itp = volTicks.begin(); itp != volTicks.end(); ++itp)
+    volumes.insert(std::make_pair(itp->second, itp->first));
+  if (total <= 0.) return;
+
+  G4int prec = G4cout.precision(3);
+  G4cout << "\n Profile : " << fProfiler->GetSeconds(total) << " s in the steps, "
+         << fProfiler->GetSeconds(fPrimaryTicks) << " s in the primary generation"
+         << G4endl;
+  const G4int nbLines = 10;
+  const std::multimap<G4double,G4String>* tables[3] = {&particles, &processes, &volumes};
+  const char* titles[3] = {"particle", "process", "volume"};
+  for (G4int k=0; k<3; k++) {
+    G4cout << "  per " << titles[k] << " :" << G4endl;
+    G4int line = 0;
+    std::multimap<G4double,G4String>::const_reverse_iterator it;
+    for (it = tables[k]->rbegin(); it != tables[k]->rend() && line < nbLines;
+         ++it, ++line) {
+      G4cout << "   " << std::setw(8) << fProfiler->GetSeconds(it->first) << " s "
+             << std::setw(6) << 100*it->first/total << " %  " << it->second << G4endl;
+    }
+  }
+  G4cout.precision(prec);
+}
+
+
+void Run::WriteProfileJson(const G4String& fileName) const
+{
+  std::ofstream file(fileName);
+  if (!file) {
+    G4cout << "\n--> warning from Run::WriteProfileJson : cannot open "
+           << fileName << G4endl;
+    return;
+  }
+
+  // times in seconds, summed over the threads
+  file << "{\n  \"events\": " << numberOfEvent
+       << ",\n  \"wallTime\": " << fWallTime
+       << ",\n  \"primaryGeneration\": " << fProfiler->GetSeconds(fPrimaryTicks)
+       << ",\n  \"particles\": {";
+  G4String sep = "\n";
+  for (size_t i=0; i<fParticleTable.size(); i++) {
+    const ParticleData& data = fParticleTable[i];
+    if (data.fSteps == 0) continue;
+    file << sep << "    \"" << data.fParticle->GetParticleName() << "\": {\"steps\": "
+         << data.fSteps << ", \"time\": " << fProfiler->GetSeconds(data.fTicks) << "}";
+    sep = ",\n";
+  }
+  file << "\n  },\n  \"processes\": {";
+  std::map<G4String,G4double> procTicks = fOtherProcTicks;
+  for (size_t i=0; i<fProcTicks.size(); i++) {
+    if (fProcTicks[i] > 0.) procTicks[fProcList[i]->GetProcessName()] += fProcTicks[i];
+  }
+  sep = "\n";
+  std::map<G4String,G4double>::const_iterator itp;
+  for (itp = procTicks.begin(); itp != procTicks.end(); ++itp) {
+    file << sep << "    \"" << itp->first << "\": {\"time\": "
+         << fProfiler->GetSeconds(itp->second) << "}";
+    sep = ",\n";
+  }
+  file << "\n  },\n  \"volumes\": {";
+  std::map<G4String,VolumeCost> volumes;
+  std::map<const G4LogicalVolume*,VolumeCost>::const_iterator itv;
+  for (itv = fVolumeCosts.begin(); itv != fVolumeCosts.end(); ++itv) {
+    volumes[itv->first->GetName()].fSteps += itv->second.fSteps;
+    volumes[itv->first->GetName()].fTicks += itv->second.fTicks;
+  }
+  sep = "\n";
+  std::map<G4String,VolumeCost>::const_iterator itn;
+  for (itn = volumes.begin(); itn != volumes.end(); ++itn) {
+    file << sep << "    \"" << itn->first << "\": {\"steps\": " << itn->second.fSteps
+         << ", \"time\": " << fProfiler->GetSeconds(itn->second.fTicks) << "}";
+    sep = ",\n";
+  }
+  file << "\n  }\n}\n";
+
+  G4cout << "\n Profile written in " << fileName << G4endl;
+}
+
+
+Run::Channel& Run::AddChannel(const G4VProcess* process,
+                              const G4String& processName,
+                              const G4ParticleDefinition* parent)
+{
+  Channel channel;
+  channel.fProcess     = process;
+  channel.fProcessName = processName;
+  channel.fParent      = parent;
+  channel.fSumW.assign(fScorer->GetNbNuclides()*kNbBands, 0.);
+  channel.fSumW2.assign(fScorer->GetNbNuclides()*kNbBands, 0.);
+  fChannels.push_back(channel);
+  return fChannels.back();
+}
+
+
+void Run::WriteChannels(const G4String& fileName) const
+{
+  std::ofstream file(fileName);
+  if (!file) {
+    G4cout << "\n--> warning from Run::WriteChannels : cannot open "
+           << fileName << G4endl;
+    return;
+  }
+
+  // one line per nuclide, channel and decade of the parent kinetic
+  // energy (MeV); the first and last bands are under- and overflow
+  file << "# " << numberOfEvent << " primaries\n";
+  file << "# nuclide process parent Emin Emax count count_err\n";
+  file.precision(8);
+  for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+    for (size_t j=0; j<fChannels.size(); j++) {
+      const Channel& channel = fChannels[j];
+      G4String parent = channel.fParent ?
+                        channel.fParent->GetParticleName() : G4String("?");
+      for (G4int b=0; b<kNbBands; b++) {
+        std::size_t k = i*kNbBands + b;
+        if (channel.fSumW[k] <= 0.) continue;
+        G4double emin = (b == 0) ? 0. : std::pow(10., kBandMin + b - 1);
+        G4double emax = (b == kNbBands-1) ? DBL_MAX : std::pow(10., kBandMin + b);
+        file << fScorer->GetName(i) << " " << channel.fProcessName
+             << " " << parent << " " << emin << " " << emax
+             << " " << channel.fSumW[k] << " " << std::sqrt(channel.fSumW2[k])
+             << "\n";
+      }
+    }
+  }
+
+  G4cout << "\n Production channels written in " << fileName << G4endl;
+}
+
+
+namespace {
+  // binary output of the response matrix
+  template <typename T> void Put(std::ostream& out, T value)
+    { out.write(reinterpret_cast<const char*>(&value), sizeof(T)); }
+}
+
+
+void Run::WriteResponse(const G4String& fileName) const
+{
+  std::ofstream file(fileName, std::ios::binary);
+  if (!file) {
+    G4cout << "\n--> warning from Run::WriteResponse : cannot open "
+           << fileName << G4endl;
+    return;
+  }
+
+  // native byte order, read by analysis/fold_response.py:
+  //   char[8] "RNRESP02", int32 nbPoints, nbNuclides, PDG code of the
+  //   primary, surface source flag; float64 Emin, Emax (MeV), radius (cm),
+  //   geometry factor (m2 sr); int64 primaries per point; per nuclide
+  //   int32 Z, A, nbins, float64 mean life (s, 0 if stable), the nbins+1
+  //   depth edges (cm) and the nbins masses (kg) of the depth bins, with
+  //   the density of each shell; then per nuclide and point the nbins
+  //   yields (nuclides per primary) and their nbins errors
+  G4int nbPoints   = fResponseN.size();
+  G4int nbNuclides = fScorer->GetNbNuclides();
+  file.write("RNRESP02", 8);
+  Put(file, std::int32_t(nbPoints));
+  Put(file, std::int32_t(nbNuclides));
+  Put(file, std::int32_t(fParticle ? fParticle->GetPDGEncoding() : 0));
+  Put(file, std::int32_t(fSurfaceSource));
+  Put(file, fScorer->GetResponseEmin()/MeV);
+  Put(file, fScorer->GetResponseEmax()/MeV);
+  Put(file, fDetector->GetRadius()/cm);
+  Put(file, GeometryFactor()/m2);
+  for (G4int p=0; p<nbPoints; p++) Put(file, std::int64_t(fResponseN[p]));
+
+  for (G4int i=0; i<nbNuclides; i++) {
+    const DepthAxis& axis = fProfiles[i];
+    G4ParticleDefinition* ion = G4IonTable::GetIonTable()->GetIon(
+                          fScorer->GetZ(i), fScorer->GetA(i), 0.);
+    G4double tau = ion ? ion->GetPDGLifeTime() : -1.;
+    Put(file, std::int32_t(fScorer->GetZ(i)));
+    Put(file, std::int32_t(fScorer->GetA(i)));
+    Put(file, std::int32_t(axis.fNbins));
+    Put(file, tau > 0. ? tau/s : 0.);
+    for (G4int bin=0; bin<=axis.fNbins && axis.fNbins>0; bin++) {
+      G4double edge = axis.fEdges.empty() ? axis.fXmin + bin/axis.fInvWidth
+                                          : axis.fEdges[bin];
+      Put(file, edge/cm);
+    }
+    for (G4int bin=1; bin<=axis.fNbins; bin++) {
+      G4double dmin = axis.fEdges.empty() ? axis.fXmin + (bin-1)/axis.fInvWidth
+                                          : axis.fEdges[bin-1];
+      G4double dmax = axis.fEdges.empty() ? axis.fXmin + bin/axis.fInvWidth
+                                          : axis.fEdges[bin];
+      Put(file, fDetector->GetLayerMass(dmin, dmax)/kg);
+    }
+  }
+
+  // under- and overflow are not written
+  for (G4int i=0; i<nbNuclides; i++) {
+    G4int nbins = fProfiles[i].fNbins;
+    for (G4int p=0; p<nbPoints; p++) {
+      G4double norm = (fResponseN[p] > 0) ? 1./fResponseN[p] : 0.;
+      std::size_t k0 = p*fDepthSize + fDepthOffsets[i];
+      for (G4int bin=1; bin<=nbins; bin++) Put(file, fResponseSw[k0+bin]*norm);
+      for (G4int bin=1; bin<=nbins; bin++) Put(file, std::sqrt(fResponseSw2[k0+bin])*norm);
+    }
+  }
+
+  G4cout << "\n Response matrix (" << nbPoints << " primary energies from "
+         << G4BestUnit(fScorer->GetResponseEmin(), "Energy") << " to "
+         << G4BestUnit(fScorer->GetResponseEmax(), "Energy")
+         << ") written in " << fileName << G4endl;
+}
+
+
+void Run::PrintSpecies() const
+{
+  G4cout << "\n Primaries and radionuclides per species of the mixed source :"
+         << G4endl;
+  G4cout << "  " << std::setw(10) << " ";
+  for (size_t j=0; j<fSpeciesNames.size(); j++)
+    G4cout << std::setw(12) << fSpeciesNames[j];
+  G4cout << "\n  " << std::setw(10) << "primaries";
+  for (size_t j=0; j<fSpeciesN.size(); j++)
+    G4cout << std::setw(12) << fSpeciesN[j];
+  G4cout << G4endl;
+
+  // share of each species in the production of a nuclide (%)
+  for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+    G4int nbins = fProfiles[i].fNbins;
+    std::vector<G4double> sum(fSpeciesNames.size(), 0.);
+    G4double total = 0.;
+    for (size_t j=0; j<fSpeciesNames.size(); j++) {
+      std::size_t k0 = j*fDepthSize + fDepthOffsets[i];
+      for (G4int bin=0; bin<nbins+2; bin++) sum[j] += fSpeciesSw[k0+bin];
+      total += sum[j];
+    }
+    if (total <= 0.) continue;
+    G4cout << "  " << std::setw(10) << fScorer->GetName(i);
+    for (size_t j=0; j<sum.size(); j++)
+      G4cout << std::setw(11) << 100.*sum[j]/total << "%";
+    G4cout << G4endl;
+  }
+}
+
+
+void Run::WriteSpecies(const G4String& fileName) const
+{
+  std::ofstream file(fileName);
+  if (!file) {
+    G4cout << "\n--> warning from Run::WriteSpecies : cannot open "
+           << fileName << G4endl;
+    return;
+  }
+
+  // depth profile of every nuclide per species, with the activity
+  // (dpm/kg) of the whole mixture split by species
+  file << "# " << numberOfEvent << " primaries:";
+  for (size_t j=0; j<fSpeciesNames.size(); j++)
+    file << " " << fSpeciesNames[j] << " " << fSpeciesN[j];
+  file << "\n# nuclide species depth_min(cm) depth_max(cm) count count_err"
+       << " activity(dpm/kg) activity_err\n";
+  file.precision(8);
+  for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+    const DepthAxis& axis = fProfiles[i];
+    G4double norm = ActivityNorm(i, -1);
+    for (size_t j=0; j<fSpeciesNames.size(); j++) {
+      std::size_t k0 = j*fDepthSize + fDepthOffsets[i];
+      for (G4int bin=1; bin<=axis.fNbins; bin++) {
+        G4double dmin = axis.fEdges.empty() ? axis.fXmin + (bin-1)/axis.fInvWidth
+                                            : axis.fEdges[bin-1];
+        G4double dmax = axis.fEdges.empty() ? axis.fXmin + bin/axis.fInvWidth
+                                            : axis.fEdges[bin];
+        G4double mass = fDetector->GetLayerMass(dmin, dmax);
+        G4double w = (mass > 0.) ? norm/(mass/kg) : 0.;
+        G4double sw = fSpeciesSw[k0+bin], err = std::sqrt(fSpeciesSw2[k0+bin]);
+        file << fScorer->GetName(i) << " " << fSpeciesNames[j]
+             << " " << dmin/cm << " " << dmax/cm << " " << sw << " " << err
+             << " " << sw*w << " " << err*w << "\n";
+      }
+    }
+  }
+
+  G4cout << "\n Radionuclides per species written in " << fileName << G4endl;
+}
+
+
+G4double Run::GeometryFactor() const
+{
+  // isotropic flux on the whole sphere, unless given
+  G4double geometry = fScorer->GetGeometryFactor();
+  if (geometry <= 0.) {
+    G4double radius = fDetector->GetRadius();
+    geometry = pi*4*pi*radius*radius;
+  }
+  return geometry;
+}
+
+
+void Run::PrintFluxNormalization() const
+{
+  // every primary enters the sphere: numberOfEvent = J * pi*4pi*R2 * T
+  G4double radius = fDetector->GetRadius();
+  G4double geometry = pi*4*pi*radius*radius;
+  G4double fluence = numberOfEvent/geometry;
+  G4cout << "\n Isotropic flux on the target surface: geometry factor pi*4pi*R2 = "
+         << geometry/m2 << " m2 sr"
+         << "\n   equivalent to an intensity integrated over time of "
+         << fluence*m2 << " particles/(m2 sr)";
+  G4double intensity = fScorer->GetIntensity();
+  if (intensity <= 0. && !fSourceIntensity.empty()) intensity = fSourceIntensity[0];
+  if (intensity > 0.) {
+    G4double time = fluence/(intensity/(m2*s));
+    G4cout << "\n   that is an exposure of " << G4BestUnit(time, "Time")
+           << " to " << intensity << " particles/(m2 sr s)";
+  }
+  G4cout << G4endl;
+}
+
+
+G4double Run::ActivityNorm(G4int nuclide, G4int iphi) const
+{
+  // activity in dpm of one created nuclide, per kg:
+  // (count/primaries) * (primaries per unit time) * (1 - exp(-t/tau))
+  G4double intensity = 0.;
+  if (iphi < 0 && fScorer->GetIntensity() > 0.) intensity = fScorer->GetIntensity();
+  else if (iphi+1 < G4int(fSourceIntensity.size())) intensity = fSourceIntensity[iphi+1];
+  if (intensity <= 0. || numberOfEvent == 0) return 0.;
+
+  G4double rate = intensity/(m2*s)*GeometryFactor();
+
+  // ground state: stable or unknown lifetime gives no activity
+  G4ParticleDefinition* ion = G4IonTable::GetIonTable()->GetIon(
+                        fScorer->GetZ(nuclide), fScorer->GetA(nuclide), 0.);
+  G4double tau = ion ? ion->GetPDGLifeTime() : -1.;
+  if (tau <= 0.) return 0.;
+  G4double exposure = fScorer->GetExposureTime();
+  G4double fraction = (exposure > 0.) ? 1. - std::exp(-exposure/tau) : 1.;
+
+  return rate/numberOfEvent*fraction*minute;
+}
+
+
+void Run::ComputeActivities()
+{
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+
+  G4bool noIntensity = true;
+  for (G4int i=0; i<fScorer->GetNbNuclides(); i++) {
+    for (G4int iphi=-1; iphi<fScorer->GetNbPhi(); iphi++) {
+      G4int ih = fScorer->GetHistoId(i, iphi);
+      G4int ia = fScorer->GetActivityHistoId(i, iphi);
+      if (!analysisManager->GetH1Activation(ia)) continue;
+      G4double norm = ActivityNorm(i, iphi);
+      if (norm <= 0.) continue;
+      noIntensity = false;
+
+      // spherical layer of each depth bin, with the density of the
+      // shells it overlaps
+      tools::histo::h1d* h1 = analysisManager->GetH1(ih);
+      G4double unit = analysisManager->GetH1Unit(ih);
+      for (G4int bin=0; bin<G4int(h1->axis().bins()); bin++) {
+        G4double mass = fDetector->GetLayerMass(h1->axis().bin_lower_edge(bin)*unit,
+                                                h1->axis().bin_upper_edge(bin)*unit);
+        if (mass <= 0.) continue;
+        G4double w = norm/(mass/kg);
+        HistoManager::SetBinContent(ia, bin+1, h1->bin_entries(bin),
+                                    h1->bin_Sw(bin)*w, h1->bin_Sw2(bin)*w*w);
+      }
+    }
+  }
+
+  if (noIntensity) {
+    G4cout << "\n--> warning from Run::ComputeActivities : "
+           << "no intensity of the primaries (/scoring/activity/intensity)"
+           << " or no activity histogram activated" << G4endl;
+    return;
+  }
+  G4cout << "\n Activity histograms (dpm/kg) computed for ";
+  if (fScorer->GetExposureTime() > 0.)
+    G4cout << "an exposure time of "
+           << G4BestUnit(fScorer->GetExposureTime(), "Time") << G4endl;
+  else
+    G4cout << "saturation" << G4endl;
 }
@@ -31,9 +31,19 @@
 #include "Run.hh"
 #include "DetectorConstruction.hh"
 #include "PrimaryGeneratorAction.hh"
+#include "GCRSpectrum.hh"
+#include "SCRSpectrum.hh"
+#include "SourceSpectrum.hh"
 #include "HistoManager.hh"
+#include "NuclideScorer.hh"
+#include "ProductionFilter.hh"
+#include "Checkpoint.hh"
+#include "Profiler.hh"
+#include "MixedSource.hh"
 
 #include "G4Run.hh"
+#include "G4GeneralParticleSource.hh"
+#include "G4SPSPosDistribution.hh"
 #include "G4UnitsTable.hh"
 #include "G4SystemOfUnits.hh"
 
@@ -41,12 +51,17 @@
 #include <iomanip>
 
 
-RunAction::RunAction(DetectorConstruction* det, PrimaryGeneratorAction* prim)
+RunAction::RunAction(DetectorConstruction* det, PrimaryGeneratorAction* prim,
+                     NuclideScorer* scorer, ProductionFilter* filter,
+                     Checkpoint* checkpoint, Profiler* profiler,
+                     MixedSource* mixed)
   : G4UserRunAction(),
-    fDetector(det), fPrimary(prim), fRun(0), fHistoManager(0)
+    fDetector(det), fPrimary(prim), fScorer(scorer), fFilter(filter),
+    fCheckpoint(checkpoint), fProfiler(profiler), fMixed(mixed),
+    fRun(0), fHistoManager(0)
 {
  // Book predefined histograms
- fHistoManager = new HistoManager(); 
+ fHistoManager = new HistoManager(scorer); 
 }
 
 
@@ -58,7 +73,7 @@ RunAction::~RunAction()
 
 G4Run* RunAction::GenerateRun()
 { 
-  fRun = new Run(fDetector); 
+  fRun = new Run(fDetector, fScorer); 
   return fRun;
 }
 
@@ -67,28 +82,137 @@ void RunAction::BeginOfRunAction(const G4Run*)
 {    
   // show Rndm status
   if (isMaster) G4Random::showEngineStatus();
+  if (isMaster) fTimer.Start();
+  if (isMaster && fProfiler->IsActive()) fProfiler->BeginOfRun();
   
+  // process ids for the per-step counters
+  fRun->RegisterProcesses();
+  fRun->SetProfiler(fProfiler);
+
+  // kill thresholds from the geometry and the scored nuclides,
+  // computed once for all threads
+  if (isMaster && fFilter->IsActive()) {
+    fFilter->ComputeThresholds(fScorer);
+    fFilter->PrintThresholds();
+  }
+
+  // mixed source: tables built once by the master, before the workers
+  // start; the species are counted in every Run
+  if (!fMixed->IsEmpty()) {
+    if (isMaster) fMixed->BuildTables();
+    std::vector<G4String> names;
+    for (G4int j=0; j<fMixed->GetNbSpecies(); j++) names.push_back(fMixed->GetName(j));
+    fRun->SetSpecies(names);
+  }
+
   // keep run condition
   if (fPrimary) { 
     G4ParticleDefinition* particle = fPrimary->GetParticleGun()->GetParticleDefinition();
+    if (fPrimary->GetSourceMode() == "gcr")
+      particle = fPrimary->GetGCRSpectrum()->GetParticle();
+    if (fPrimary->GetSourceMode() == "scr")
+      particle = fPrimary->GetSCRSpectrum()->GetParticle();
+    if (fPrimary->GetSourceMode() == "mixed") particle = 0;
     G4double energy = fPrimary->GetParticleGun()->GetParticleEnergy();
     fRun->SetPrimary(particle, energy);
+    fRun->SetSurfaceSource(fPrimary->IsSurfaceSource());
+
+    // activity normalization
+    if (fPrimary->GetSourceMode() == "gcr") {
+      GCRSpectrum* spectrum = fPrimary->GetGCRSpectrum();
+      std::vector<G4double> intensity(1, spectrum->GetIntegralFlux());
+      for (G4int iphi=0; iphi<fScorer->GetNbPhi(); iphi++)
+        intensity.push_back(spectrum->IntegralFlux(fScorer->GetPhi(iphi)));
+      fRun->SetSourceIntensity(intensity);
+    }
+    if (fPrimary->GetSourceMode() == "scr") {
+      SCRSpectrum* spectrum = fPrimary->GetSCRSpectrum();
+      fRun->SetSourceIntensity(std::vector<G4double>(1, spectrum->GetIntegralFlux()));
+    }
+    if (fPrimary->GetSourceMode() == "mixed") {
+      fRun->SetSourceIntensity(std::vector<G4double>(1, fMixed->GetIntegralFlux()));
+    }
   }
              
   //histograms
+  fHistoManager->SetBinning();
+  if (fPrimary && fScorer->GetNbPhi() > 0 && fPrimary->GetSourceMode() != "gcr") {
+    G4cout << "\n--> warning from RunAction::BeginOfRunAction : "
+           << "reweighting to /scoring/phi/ needs /source/mode gcr;"
+           << " the reweighted histograms stay empty" << G4endl;
+  }
+  if (fPrimary && fPrimary->GetSourceMode() == "table"
+      && fPrimary->GetSourceSpectrum()->IsEmpty()) {
+    G4cout << "\n--> warning from RunAction::BeginOfRunAction : "
+           << "/source/mode table without /source/spectrum/load;"
+           << " the energies are the ones of the /gps/ commands" << G4endl;
+  }
+  // SCR production is confined to the first cm: with the GPS sphere
+  // most primaries would miss the target or hit it at grazing incidence
+  if (fPrimary && fPrimary->GetSourceMode() == "scr"
+      && !fPrimary->IsSurfaceSource()) {
+    G4cout << "\n--> warning from RunAction::BeginOfRunAction : "
+           << "/source/mode scr is meant for /source/position surface"
+           << G4endl;
+  }
+  // GPS position: the primaries must start inside the world box
+  if (fPrimary && !fPrimary->IsSurfaceSource()) {
+    G4SPSPosDistribution* pos =
+      fPrimary->GetParticleGun()->GetCurrentSource()->GetPosDist();
+    G4ThreeVector centre = pos->GetCentreCoords();
+    G4double extent = (pos->GetPosDisType() == "Point") ? 0. : pos->GetRadius();
+    G4double world = fDetector->GetWorldSize();
+    if (std::abs(centre.x()) + extent > world || std::abs(centre.y()) + extent > world
+        || std::abs(centre.z()) + extent > world) {
+      G4cout << "\n--> warning from RunAction::BeginOfRunAction : "
+             << "the GPS source extends outside the world (half-size "
+             << G4BestUnit(world, "Length") << "); primaries starting outside"
+             << " are lost. Use /source/position surface" << G4endl;
+    }
+  }
+  if (fPrimary && fPrimary->GetSourceMode() == "mixed" && fMixed->IsEmpty()) {
+    G4cout << "\n--> warning from RunAction::BeginOfRunAction : "
+           << "/source/mode mixed without /source/mixed/add;"
+           << " the primaries are the ones of the /gps/ commands" << G4endl;
+  }
+  if (fPrimary && fPrimary->GetSourceMode() == "grid"
+      && fScorer->GetNbResponsePoints() == 0) {
+    G4cout << "\n--> warning from RunAction::BeginOfRunAction : "
+           << "/source/mode grid without /scoring/response/grid;"
+           << " the energies are the ones of the /gps/ commands" << G4endl;
+  }
+  fHistoManager->ActivateRecords(fScorer->GetRecords());
+  // the histograms are filled and written by the master only, at the
+  // last segment of a checkpointed job; with the nuclide records the
+  // workers open the file to send their ntuple
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
-  if ( analysisManager->IsActive() )
-    analysisManager->OpenFile();
+  G4bool open = (isMaster && fCheckpoint->IsLastSegment()) || fScorer->GetRecords();
+  if ( open && analysisManager->IsActive() ) {
+    G4String fileName = isMaster ? fCheckpoint->GetOutputFileName() : "";
+    if (fileName == "") analysisManager->OpenFile();
+    else                analysisManager->OpenFile(fileName);
+  }
 }
 
 
 void RunAction::EndOfRunAction(const G4Run*)
 {
-  if (isMaster) fRun->EndOfRun();    
+  // a checkpointed job sums its segments, the results are the ones of the sum
+  if (isMaster) {
+    fTimer.Stop();
+    fRun->SetWallTime(fTimer.GetRealElapsed());
+    if (fProfiler->IsActive()) fProfiler->EndOfRun();
+    Run* run = fCheckpoint->IsActive() ? fCheckpoint->EndOfSegment(fRun) : fRun;
+    if (run) {
+      fHistoManager->FillProfiles(run);
+      run->EndOfRun();
+      if (fCheckpoint->IsShard()) fCheckpoint->WriteShard(run);
+    }
+  }
   
   //save histograms      
   G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
-  if ( analysisManager->IsActive() ) {
+  if ( analysisManager->IsOpenFile() ) {
     analysisManager->Write();
     analysisManager->CloseFile();
   }
@@ -96,3 +220,20 @@ void RunAction::EndOfRunAction(const G4Run*)
   // show Rndm status
   if (isMaster) G4Random::showEngineStatus();
 }
+
+
+void RunAction::WriteResults(Run* run) const
+{
+  // e.g. the sum of the shards of a job, written as at the end of a run
+  fHistoManager->SetBinning();
+  G4AnalysisManager* analysisManager = G4AnalysisManager::Instance();
+  if ( analysisManager->IsActive() ) analysisManager->OpenFile();
+
+  fHistoManager->FillProfiles(run);
+  run->EndOfRun();
+
+  if ( analysisManager->IsOpenFile() ) {
+    analysisManager->Write();
+    analysisManager->CloseFile();
+  }
+}
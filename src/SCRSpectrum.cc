@@ -0,0 +1,109 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SCRSpectrum.cc
+/// \brief Implementation of the SCRSpectrum class
+
+#include "SCRSpectrum.hh"
+
+#include "G4ParticleTable.hh"
+#include "G4ParticleDefinition.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include "Randomize.hh"
+
+
+SCRSpectrum::SCRSpectrum()
+: fParticle(0), fR0(100*megavolt), fFlux(100/(cm2*s)), fFluxAbove(10*MeV),
+  fEmin(1*MeV), fEmax(1*GeV)
+{
+  SetParticle("proton");
+}
+
+
+SCRSpectrum::~SCRSpectrum()
+{}
+
+
+void SCRSpectrum::SetParticle(const G4String& name)
+{
+  G4ParticleDefinition* particle =
+    G4ParticleTable::GetParticleTable()->FindParticle(name);
+  if (!particle || (name != "proton" && name != "alpha")) {
+    G4cout << "\n--> warning from SCRSpectrum::SetParticle : "
+           << name << " has no SCR spectrum (proton, alpha)" << G4endl;
+    return;
+  }
+  fParticle = particle;
+}
+
+
+void SCRSpectrum::SetEnergyRange(G4double emin, G4double emax)
+{
+  if (emin <= 0. || emax <= emin) {
+    G4cout << "\n--> warning from SCRSpectrum::SetEnergyRange : "
+           << "wrong range " << G4BestUnit(emin, "Energy") << " - "
+           << G4BestUnit(emax, "Energy") << G4endl;
+    return;
+  }
+  fEmin = emin;
+  fEmax = emax;
+}
+
+
+G4double SCRSpectrum::Rigidity(G4double ekin) const
+{
+  G4double mass = fParticle->GetPDGMass();
+  G4double charge = fParticle->GetPDGCharge();
+  return std::sqrt(ekin*(ekin + 2*mass))/charge;
+}
+
+
+G4double SCRSpectrum::KineticEnergy(G4double rigidity) const
+{
+  G4double mass = fParticle->GetPDGMass();
+  G4double p = rigidity*fParticle->GetPDGCharge();
+  return std::sqrt(p*p + mass*mass) - mass;
+}
+
+
+G4double SCRSpectrum::Sample() const
+{
+  G4double xmin = std::exp(-Rigidity(fEmin)/fR0);
+  G4double xmax = std::exp(-Rigidity(fEmax)/fR0);
+  G4double rigidity = -fR0*std::log(xmin - G4UniformRand()*(xmin - xmax));
+  return KineticEnergy(rigidity);
+}
+
+
+G4double SCRSpectrum::GetIntegralFlux() const
+{
+  G4double above = Rigidity(fFluxAbove);
+  G4double j = fFlux/(4*pi)*(std::exp(-(Rigidity(fEmin) - above)/fR0)
+                           - std::exp(-(Rigidity(fEmax) - above)/fR0));
+  return j*m2*s;
+}
@@ -0,0 +1,245 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ScoringMessenger.cc
+/// \brief Implementation of the ScoringMessenger class
+
+#include "ScoringMessenger.hh"
+#include "NuclideScorer.hh"
+#include "HistoManager.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithADouble.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithoutParameter.hh"
+#include "G4UIcmdWithABool.hh"
+#include "G4NistManager.hh"
+
+
+ScoringMessenger::ScoringMessenger(NuclideScorer* scorer)
+:G4UImessenger(),
+ fScorer(scorer), fScoringDir(0), fNuclideDir(0), fAddCmd(0),
+ fMaxDepthCmd(0), fListCmd(0), fRecordsCmd(0), fPhiDir(0), fPhiCmd(0),
+ fActivityDir(0), fExposureCmd(0), fIntensityCmd(0), fGeometryCmd(0),
+ fResponseDir(0), fGridCmd(0)
+{
+  G4bool broadcast = false;
+  fScoringDir = new G4UIdirectory("/scoring/", broadcast);
+  fScoringDir->SetGuidance("scoring commands");
+
+  fNuclideDir = new G4UIdirectory("/scoring/nuclide/", broadcast);
+  fNuclideDir->SetGuidance("radionuclides production scoring");
+
+  fAddCmd = new G4UIcommand("/scoring/nuclide/add", this);
+  fAddCmd->SetGuidance("Score the production of a radionuclide.");
+  fAddCmd->SetGuidance("  element symbol, A");
+  fAddCmd->SetGuidance("A new histogram is booked with the next free id.");
+  //
+  G4UIparameter* symbPrm = new G4UIparameter("element", 's', false);
+  symbPrm->SetGuidance("element symbol");
+  fAddCmd->SetParameter(symbPrm);
+  //
+  G4UIparameter* APrm = new G4UIparameter("A", 'i', false);
+  APrm->SetGuidance("A");
+  APrm->SetParameterRange("A > 0");
+  fAddCmd->SetParameter(APrm);
+  //
+  fAddCmd->AvailableForStates(G4State_PreInit);
+
+  fMaxDepthCmd = new G4UIcmdWithADoubleAndUnit("/scoring/nuclide/maxDepth",this);
+  fMaxDepthCmd->SetGuidance("Score only radionuclides created above this depth");
+  fMaxDepthCmd->SetParameterName("depth", false);
+  fMaxDepthCmd->SetRange("depth > 0.");
+  fMaxDepthCmd->SetUnitCategory("Length");
+  fMaxDepthCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fListCmd = new G4UIcmdWithoutParameter("/scoring/nuclide/list", this);
+  fListCmd->SetGuidance("List the scored radionuclides and their histogram id");
+  fListCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fRecordsCmd = new G4UIcmdWithABool("/scoring/nuclide/records", this);
+  fRecordsCmd->SetGuidance("Write one ntuple row per scored radionuclide:");
+  fRecordsCmd->SetGuidance("  Z, A, depth (cm), kinetic energy (MeV), PDG code of the");
+  fRecordsCmd->SetGuidance("  parent, primary energy (MeV) and weight.");
+  fRecordsCmd->SetGuidance("Same depth cut as the histograms (default false).");
+  fRecordsCmd->SetParameterName("flag", true);
+  fRecordsCmd->SetDefaultValue(true);
+  fRecordsCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fPhiDir = new G4UIdirectory("/scoring/phi/", broadcast);
+  fPhiDir->SetGuidance("reweighting to other solar modulation parameters");
+
+  fPhiCmd = new G4UIcmdWithADoubleAndUnit("/scoring/phi/add", this);
+  fPhiCmd->SetGuidance("Add a modulation parameter to the reweighting list.");
+  fPhiCmd->SetGuidance("Every scored radionuclide gets a histogram filled with");
+  fPhiCmd->SetGuidance("the weight J(E,phi)/J(E,phiRef), E = primary energy,");
+  fPhiCmd->SetGuidance("normalized to the same number of primaries.");
+  fPhiCmd->SetGuidance("Needs /source/mode gcr (phiRef = /source/gcr/phi);");
+  fPhiCmd->SetGuidance("the binning is the one of the nuclide histogram.");
+  fPhiCmd->SetParameterName("phi", false);
+  fPhiCmd->SetRange("phi >= 0.");
+  fPhiCmd->SetUnitCategory("Energy");
+  fPhiCmd->AvailableForStates(G4State_PreInit);
+
+  fActivityDir = new G4UIdirectory("/scoring/activity/", broadcast);
+  fActivityDir->SetGuidance("activity (dpm/kg) computed at the end of the run");
+
+  fExposureCmd = new G4UIcmdWithADoubleAndUnit("/scoring/activity/exposureTime",this);
+  fExposureCmd->SetGuidance("Cosmic-ray exposure time of the meteorite");
+  fExposureCmd->SetGuidance("  (0: saturation activity, the default)");
+  fExposureCmd->SetParameterName("time", false);
+  fExposureCmd->SetRange("time >= 0.");
+  fExposureCmd->SetUnitCategory("Time");
+  fExposureCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fIntensityCmd = new G4UIcmdWithADouble("/scoring/activity/intensity", this);
+  fIntensityCmd->SetGuidance("Integral intensity of the primaries, in particles/(m2 sr s)");
+  fIntensityCmd->SetGuidance("  (0: the one of the GCR source, the default;");
+  fIntensityCmd->SetGuidance("  it must be given with /source/mode gps)");
+  fIntensityCmd->SetParameterName("intensity", false);
+  fIntensityCmd->SetRange("intensity >= 0.");
+  fIntensityCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fGeometryCmd = new G4UIcmdWithADoubleAndUnit("/scoring/activity/geometryFactor",this);
+  fGeometryCmd->SetGuidance("Geometry factor of the source, area times solid angle (sr)");
+  fGeometryCmd->SetGuidance("  (0: isotropic flux on the whole sphere, pi*4*pi*R2)");
+  fGeometryCmd->SetParameterName("G", false);
+  fGeometryCmd->SetRange("G >= 0.");
+  fGeometryCmd->SetUnitCategory("Surface");
+  fGeometryCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fResponseDir = new G4UIdirectory("/scoring/response/", broadcast);
+  fResponseDir->SetGuidance("response matrix: production per primary energy");
+
+  fGridCmd = new G4UIcommand("/scoring/response/grid", this);
+  fGridCmd->SetGuidance("Set the log grid of the primary kinetic energies");
+  fGridCmd->SetGuidance("  Emin, Emax, number of points, unit");
+  fGridCmd->SetGuidance("With /source/mode grid, event i has the energy of point");
+  fGridCmd->SetGuidance("i modulo the number of points; the depth profiles per");
+  fGridCmd->SetGuidance("point are written in <fileName>_response.bin.");
+  fGridCmd->SetGuidance("0 points: no response matrix (the default).");
+  //
+  G4UIparameter* eminPrm = new G4UIparameter("Emin", 'd', false);
+  eminPrm->SetParameterRange("Emin > 0.");
+  fGridCmd->SetParameter(eminPrm);
+  //
+  G4UIparameter* emaxPrm = new G4UIparameter("Emax", 'd', false);
+  emaxPrm->SetParameterRange("Emax > 0.");
+  fGridCmd->SetParameter(emaxPrm);
+  //
+  G4UIparameter* nPrm = new G4UIparameter("nbPoints", 'i', false);
+  nPrm->SetParameterRange("nbPoints >= 0");
+  fGridCmd->SetParameter(nPrm);
+  //
+  G4UIparameter* unitPrm = new G4UIparameter("unit", 's', true);
+  unitPrm->SetDefaultValue("MeV");
+  unitPrm->SetParameterCandidates(G4UIcommand::UnitsList("Energy"));
+  fGridCmd->SetParameter(unitPrm);
+  //
+  fGridCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+
+ScoringMessenger::~ScoringMessenger()
+{
+  delete fAddCmd;
+  delete fMaxDepthCmd;
+  delete fListCmd;
+  delete fRecordsCmd;
+  delete fPhiCmd;
+  delete fPhiDir;
+  delete fExposureCmd;
+  delete fIntensityCmd;
+  delete fGeometryCmd;
+  delete fActivityDir;
+  delete fGridCmd;
+  delete fResponseDir;
+  delete fNuclideDir;
+  delete fScoringDir;
+}
+
+
+void ScoringMessenger::BookNewHistos(G4int first)
+{
+  // the histograms booked by the HistoManager of the worker threads
+  // follow the same order
+  for (G4int id=first; id<fScorer->GetNbHistos(); id++) {
+    HistoManager::BookHisto(id, fScorer->GetHistoTitle(id));
+  }
+}
+
+
+void ScoringMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fAddCmd)
+   {
+     G4String symbol; G4int A;
+     std::istringstream is(newValue);
+     is >> symbol >> A;
+     G4int Z = G4NistManager::Instance()->GetZ(symbol);
+     G4int nh = fScorer->GetNbHistos();
+     fScorer->AddNuclide(Z, A);
+     BookNewHistos(nh);
+   }
+
+  if (command == fPhiCmd)
+   {
+     G4int nh = fScorer->GetNbHistos();
+     fScorer->AddPhi(fPhiCmd->GetNewDoubleValue(newValue));
+     BookNewHistos(nh);
+   }
+
+  if (command == fMaxDepthCmd)
+   { fScorer->SetMaxDepth(fMaxDepthCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fListCmd)
+   { fScorer->ListNuclides();}
+
+  if (command == fRecordsCmd)
+   { fScorer->SetRecords(fRecordsCmd->GetNewBoolValue(newValue));}
+
+  if (command == fExposureCmd)
+   { fScorer->SetExposureTime(fExposureCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fIntensityCmd)
+   { fScorer->SetIntensity(fIntensityCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fGeometryCmd)
+   { fScorer->SetGeometryFactor(fGeometryCmd->GetNewDoubleValue(newValue));}
+
+  if (command == fGridCmd)
+   {
+     G4double emin, emax;
+     G4int n;
+     G4String unit;
+     std::istringstream is(newValue);
+     is >> emin >> emax >> n >> unit;
+     G4double u = G4UIcommand::ValueOf(unit);
+     fScorer->SetResponseGrid(emin*u, emax*u, n);
+   }
+}
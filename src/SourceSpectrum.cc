@@ -0,0 +1,168 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SourceSpectrum.cc
+/// \brief Implementation of the SourceSpectrum class
+
+#include "SourceSpectrum.hh"
+#include "SourceSpectrumMessenger.hh"
+
+#include "G4UnitsTable.hh"
+#include "G4SystemOfUnits.hh"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+
+SourceSpectrum::SourceSpectrum()
+: fSpectrumMessenger(0)
+{
+  fSpectrumMessenger = new SourceSpectrumMessenger(this);
+}
+
+
+SourceSpectrum::~SourceSpectrum()
+{
+  delete fSpectrumMessenger;
+}
+
+
+G4bool SourceSpectrum::Load(const G4String& fileName, G4double energyUnit)
+{
+  std::ifstream file(fileName, std::ios::binary);
+  if (!file) {
+    G4cout << "\n--> warning from SourceSpectrum::Load : cannot open "
+           << fileName << G4endl;
+    return false;
+  }
+
+  char magic[8] = {0};
+  file.read(magic, 8);
+  G4bool binary = file.gcount() == 8 && std::memcmp(magic, "RNSPEC01", 8) == 0;
+  if (!binary) { file.clear(); file.seekg(0); }
+  fEnergy.clear();
+  fFlux.clear();
+  G4bool ok = binary ? ReadBinary(file) : ReadText(file, energyUnit);
+
+  // energies strictly increasing, fluxes positive or null
+  for (size_t i=0; ok && i<fEnergy.size(); i++) {
+    if (fFlux[i] < 0. || (i > 0 && fEnergy[i] <= fEnergy[i-1])) {
+      G4cout << "\n--> warning from SourceSpectrum::Load : " << fileName
+             << ", point " << i << ": energies must increase and fluxes"
+             << " be positive" << G4endl;
+      ok = false;
+    }
+  }
+  if (ok && fEnergy.size() < 2) {
+    G4cout << "\n--> warning from SourceSpectrum::Load : " << fileName
+           << " has less than two points" << G4endl;
+    ok = false;
+  }
+  if (!ok) {
+    fEnergy.clear();
+    fFlux.clear();
+    fSampler = SpectrumSampler();
+    fFileName = "";
+    return false;
+  }
+
+  // alias table built once, read by all threads
+  fSampler.SetTable(fEnergy, fFlux);
+  fFileName = fileName;
+  G4cout << "\n Source spectrum " << fileName << ": " << fEnergy.size()
+         << " points from " << G4BestUnit(fEnergy.front(), "Energy")
+         << " to " << G4BestUnit(fEnergy.back(), "Energy") << G4endl;
+  return !fSampler.IsEmpty();
+}
+
+
+G4bool SourceSpectrum::ReadBinary(std::istream& in)
+{
+  std::int64_t n = 0;
+  in.read(reinterpret_cast<char*>(&n), sizeof(n));
+  if (!in || n < 0) return false;
+  fEnergy.resize(n);
+  fFlux.resize(n);
+  in.read(reinterpret_cast<char*>(fEnergy.data()), n*sizeof(G4double));
+  in.read(reinterpret_cast<char*>(fFlux.data()), n*sizeof(G4double));
+  if (!in) {
+    G4cout << "\n--> warning from SourceSpectrum::ReadBinary : "
+           << "truncated file" << G4endl;
+    return false;
+  }
+  for (size_t i=0; i<fEnergy.size(); i++) fEnergy[i] *= MeV;
+  return true;
+}
+
+
+G4bool SourceSpectrum::ReadText(std::istream& in, G4double energyUnit)
+{
+  // E, J per line; lines without two numbers (e.g. a CSV header) are skipped
+  G4int skipped = 0;
+  std::string line;
+  while (std::getline(in, line)) {
+    std::size_t comment = line.find('#');
+    if (comment != std::string::npos) line.erase(comment);
+    if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+    for (size_t i=0; i<line.size(); i++) if (line[i] == ',') line[i] = ' ';
+    const char* begin = line.c_str();
+    char* end;
+    G4double e = std::strtod(begin, &end);
+    if (end == begin) { skipped++; continue; }
+    begin = end;
+    G4double j = std::strtod(begin, &end);
+    if (end == begin) { skipped++; continue; }
+    fEnergy.push_back(e*energyUnit);
+    fFlux.push_back(j);
+  }
+  if (skipped > 0) {
+    G4cout << "\n--> warning from SourceSpectrum::ReadText : "
+           << skipped << " lines without two numbers skipped" << G4endl;
+  }
+  return true;
+}
+
+
+G4bool SourceSpectrum::Save(const G4String& fileName) const
+{
+  std::ofstream file(fileName, std::ios::binary);
+  if (!file || fEnergy.empty()) {
+    G4cout << "\n--> warning from SourceSpectrum::Save : cannot write "
+           << fileName << G4endl;
+    return false;
+  }
+  std::int64_t n = fEnergy.size();
+  std::vector<G4double> energy(fEnergy);
+  for (size_t i=0; i<energy.size(); i++) energy[i] /= MeV;
+  file.write("RNSPEC01", 8);
+  file.write(reinterpret_cast<const char*>(&n), sizeof(n));
+  file.write(reinterpret_cast<const char*>(energy.data()), n*sizeof(G4double));
+  file.write(reinterpret_cast<const char*>(fFlux.data()), n*sizeof(G4double));
+  G4cout << "\n Source spectrum written in " << fileName << G4endl;
+  return bool(file);
+}
@@ -0,0 +1,92 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SourceSpectrumMessenger.cc
+/// \brief Implementation of the SourceSpectrumMessenger class
+
+#include "SourceSpectrumMessenger.hh"
+#include "SourceSpectrum.hh"
+
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+
+
+SourceSpectrumMessenger::SourceSpectrumMessenger(SourceSpectrum* spectrum)
+:G4UImessenger(),
+ fSpectrum(spectrum), fSpectrumDir(0), fLoadCmd(0), fSaveCmd(0)
+{
+  // executed by the master only: the table is shared by the workers
+  G4bool broadcast = false;
+  fSpectrumDir = new G4UIdirectory("/source/spectrum/", broadcast);
+  fSpectrumDir->SetGuidance("tabulated spectrum of the primaries (/source/mode table)");
+
+  fLoadCmd = new G4UIcommand("/source/spectrum/load", this);
+  fLoadCmd->SetGuidance("Read the spectrum from a file:");
+  fLoadCmd->SetGuidance("  text: kinetic energy and flux per line, blanks or commas");
+  fLoadCmd->SetGuidance("  binary: as written by /source/spectrum/save");
+  fLoadCmd->SetGuidance("The spectrum is interpolated as a power law between points.");
+  fLoadCmd->SetGuidance("  fileName, energy unit of a text file");
+  //
+  G4UIparameter* filePrm = new G4UIparameter("fileName", 's', false);
+  fLoadCmd->SetParameter(filePrm);
+  //
+  G4UIparameter* unitPrm = new G4UIparameter("unit", 's', true);
+  unitPrm->SetDefaultValue("MeV");
+  unitPrm->SetParameterCandidates(G4UIcommand::UnitsList("Energy"));
+  fLoadCmd->SetParameter(unitPrm);
+  //
+  fLoadCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+
+  fSaveCmd = new G4UIcmdWithAString("/source/spectrum/save", this);
+  fSaveCmd->SetGuidance("Write the loaded spectrum in a binary file");
+  fSaveCmd->SetParameterName("fileName", false);
+  fSaveCmd->AvailableForStates(G4State_PreInit, G4State_Idle);
+}
+
+
+SourceSpectrumMessenger::~SourceSpectrumMessenger()
+{
+  delete fLoadCmd;
+  delete fSaveCmd;
+  delete fSpectrumDir;
+}
+
+
+void SourceSpectrumMessenger::SetNewValue(G4UIcommand* command, G4String newValue)
+{
+  if (command == fLoadCmd)
+   {
+     G4String fileName, unit;
+     std::istringstream is(newValue);
+     is >> fileName >> unit;
+     fSpectrum->Load(fileName, G4UIcommand::ValueOf(unit));
+   }
+
+  if (command == fSaveCmd)
+   { fSpectrum->Save(newValue);}
+}
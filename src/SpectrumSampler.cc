@@ -0,0 +1,139 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file SpectrumSampler.cc
+/// \brief Implementation of the SpectrumSampler class
+
+#include "SpectrumSampler.hh"
+
+#include "Randomize.hh"
+#include <cfloat>
+
+
+SpectrumSampler::SpectrumSampler()
+: fIntegral(0.)
+{}
+
+
+SpectrumSampler::~SpectrumSampler()
+{}
+
+
+void SpectrumSampler::SetTable(const std::vector<G4double>& energies,
+                               const std::vector<G4double>& flux)
+{
+  fEnergy = energies;
+  fFlux   = flux;
+  fSlope.clear();
+  fProb.clear();
+  fAlias.clear();
+  fIntegral = 0.;
+
+  G4int nbins = G4int(fEnergy.size()) - 1;
+  if (nbins < 1 || fFlux.size() != fEnergy.size()) {
+    G4cout << "\n--> warning from SpectrumSampler::SetTable : "
+           << "at least two points of the spectrum are needed" << G4endl;
+    return;
+  }
+
+  // integral of each bin
+  std::vector<G4double> weight(nbins);
+  fSlope.resize(nbins);
+  for (G4int i=0; i<nbins; i++) {
+    G4double e0 = fEnergy[i], e1 = fEnergy[i+1];
+    G4double j0 = fFlux[i],   j1 = fFlux[i+1];
+    if (e0 > 0. && j0 > 0. && j1 > 0.)
+      fSlope[i] = std::log(j1/j0)/std::log(e1/e0);
+    else
+      fSlope[i] = DBL_MAX;          // linear interpolation
+    weight[i] = BinIntegral(e0, e1, j0, j1);
+    fIntegral += weight[i];
+  }
+  if (fIntegral <= 0.) {
+    G4cout << "\n--> warning from SpectrumSampler::SetTable : "
+           << "null spectrum" << G4endl;
+    fSlope.clear();
+    return;
+  }
+
+  // Walker alias table (Vose's algorithm)
+  fProb.resize(nbins);
+  fAlias.assign(nbins, 0);
+  std::vector<G4int> small, large;
+  for (G4int i=0; i<nbins; i++) {
+    fProb[i] = weight[i]*nbins/fIntegral;
+    if (fProb[i] < 1.) small.push_back(i);
+    else               large.push_back(i);
+  }
+  while (!small.empty() && !large.empty()) {
+    G4int s = small.back(); small.pop_back();
+    G4int l = large.back();
+    fAlias[s] = l;
+    fProb[l] -= 1. - fProb[s];
+    if (fProb[l] < 1.) { large.pop_back(); small.push_back(l); }
+  }
+  // leftovers are 1 within rounding
+  for (size_t i=0; i<small.size(); i++) fProb[small[i]] = 1.;
+  for (size_t i=0; i<large.size(); i++) fProb[large[i]] = 1.;
+}
+
+
+G4double SpectrumSampler::BinIntegral(G4double e0, G4double e1,
+                                      G4double j0, G4double j1)
+{
+  if (e0 > 0. && j0 > 0. && j1 > 0.) {
+    // power law
+    G4double g1 = std::log(j1/j0)/std::log(e1/e0) + 1.;
+    if (std::abs(g1) < 1.e-6) return j0*e0*std::log(e1/e0);
+    return j0*e0*(std::pow(e1/e0, g1) - 1.)/g1;
+  }
+  return 0.5*(j0 + j1)*(e1 - e0);
+}
+
+
+G4double SpectrumSampler::Sample() const
+{
+  // choose the bin
+  G4int nbins = fProb.size();
+  G4double u = G4UniformRand()*nbins;
+  G4int i = std::min(G4int(u), nbins-1);
+  if (u - i >= fProb[i]) i = fAlias[i];
+
+  // energy within the bin
+  G4double e0 = fEnergy[i], e1 = fEnergy[i+1];
+  G4double r = G4UniformRand();
+  if (fSlope[i] == DBL_MAX) {
+    G4double j0 = fFlux[i], j1 = fFlux[i+1];
+    G4double t = r;
+    if (std::abs(j1 - j0) > 1.e-9*(j0 + j1)) {
+      t = (std::sqrt(j0*j0 + r*(j1*j1 - j0*j0)) - j0)/(j1 - j0);
+    }
+    return e0 + t*(e1 - e0);
+  }
+  G4double g1 = fSlope[i] + 1.;
+  if (std::abs(g1) < 1.e-6) return e0*std::pow(e1/e0, r);
+  return e0*std::pow(1. + r*(std::pow(e1/e0, g1) - 1.), 1./g1);
+}
@@ -0,0 +1,58 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StackingAction.cc
+/// \brief Implementation of the StackingAction class
+
+#include "StackingAction.hh"
+#include "ProductionFilter.hh"
+#include "Run.hh"
+
+#include "G4RunManager.hh"
+#include "G4Track.hh"
+
+
+StackingAction::StackingAction(ProductionFilter* filter)
+: G4UserStackingAction(), fFilter(filter)
+{}
+
+
+StackingAction::~StackingAction()
+{}
+
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track* track)
+{
+  // keep the primaries and everything that can still produce a nuclide
+  if (!fFilter->IsActive() || track->GetParentID() == 0) return fUrgent;
+  const G4ParticleDefinition* particle = track->GetParticleDefinition();
+  if (!fFilter->IsIrrelevant(particle, track->GetKineticEnergy())) return fUrgent;
+
+  Run* run = static_cast<Run*>(
+        G4RunManager::GetRunManager()->GetNonConstCurrentRun());
+  run->KilledCount(particle);
+  return fKill;
+}
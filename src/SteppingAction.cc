@@ -32,12 +32,24 @@
 #include "Run.hh"
 #include "EventAction.hh"
 #include "HistoManager.hh"
+#include "ImportanceBiasing.hh"
+#include "ProductionFilter.hh"
+#include "NuclideScorer.hh"
+#include "ParentInformation.hh"
+#include "Profiler.hh"
 
 #include "G4RunManager.hh"
+#include "G4SteppingManager.hh"
+#include "G4VPhysicalVolume.hh"
+#include "G4Track.hh"
+#include "Randomize.hh"
                            
 
-SteppingAction::SteppingAction(EventAction* event)
-: G4UserSteppingAction(), fEventAction(event)
+SteppingAction::SteppingAction(EventAction* event, ImportanceBiasing* biasing,
+                               ProductionFilter* filter, NuclideScorer* scorer,
+                               Profiler* profiler)
+: G4UserSteppingAction(), fEventAction(event), fBiasing(biasing), fFilter(filter),
+  fScorer(scorer), fProfiler(profiler)
 {}
 
 
@@ -54,4 +66,85 @@ void SteppingAction::UserSteppingAction(const G4Step* aStep)
   Run* run = static_cast<Run*>(
         G4RunManager::GetRunManager()->GetNonConstCurrentRun());
   run->CountProcesses(process);
+  if (fProfiler->IsActive()) run->ProfileStep(aStep, Profiler::Ticks());
+
+  // parent of the radionuclides created in this step
+  if (aStep->GetNumberOfSecondariesInCurrentStep() > 0) TagNuclides(aStep);
+
+  if (endPoint->GetStepStatus() != fGeomBoundary) return;
+
+  // leaving the meteorite for the vacuum of the world (the mother of
+  // the meteorite volumes): a convex body, the track cannot come back
+  if (fFilter->IsActive()) {
+    const G4VPhysicalVolume* postVolume = endPoint->GetPhysicalVolume();
+    if (postVolume && !postVolume->GetMotherLogical()
+        && aStep->GetPreStepPoint()->GetPhysicalVolume()->GetMotherLogical()) {
+      aStep->GetTrack()->SetTrackStatus(fStopAndKill);
+      run->CountEscaped();
+      return;
+    }
+  }
+
+  // importance splitting at the shell boundaries
+  if (fBiasing->IsActive()) SplitOrKill(aStep, run);
+}
+
+
+void SteppingAction::SplitOrKill(const G4Step* aStep, Run* run)
+{
+  G4Track* track = aStep->GetTrack();
+  if (!fBiasing->IsBiased(track->GetParticleDefinition())) return;
+  const G4VPhysicalVolume* preVolume  = aStep->GetPreStepPoint()->GetPhysicalVolume();
+  const G4VPhysicalVolume* postVolume = aStep->GetPostStepPoint()->GetPhysicalVolume();
+  if (!preVolume || !postVolume) return;
+
+  G4double ratio = fBiasing->ImportanceRatio(preVolume->GetCopyNo(),
+                                             postVolume->GetCopyNo());
+  if (ratio == 1.) return;
+  G4double weight = track->GetWeight()/ratio;
+
+  // Russian roulette: survives with probability ratio
+  if (ratio < 1.) {
+    if (G4UniformRand() < ratio) {
+      track->SetWeight(weight);
+    }
+    else {
+      track->SetTrackStatus(fStopAndKill);
+      run->CountRoulette();
+    }
+    return;
+  }
+
+  // splitting: ratio copies on average, the track being one of them
+  G4int nCopies = G4int(ratio);
+  if (G4UniformRand() < ratio - nCopies) nCopies++;
+  track->SetWeight(weight);
+  const G4StepPoint* endPoint = aStep->GetPostStepPoint();
+  for (G4int i=1; i<nCopies; i++) {
+    G4Track* copy = new G4Track(
+      new G4DynamicParticle(*track->GetDynamicParticle()),
+      endPoint->GetGlobalTime(), endPoint->GetPosition());
+    copy->SetWeight(weight);
+    copy->SetParentID(track->GetTrackID());
+    copy->SetTouchableHandle(endPoint->GetTouchableHandle());
+    fpSteppingManager->GetfSecondary()->push_back(copy);
+  }
+  run->CountSplit(nCopies - 1);
+}
+
+
+void SteppingAction::TagNuclides(const G4Step* aStep)
+{
+  const std::vector<const G4Track*>* secondaries =
+    aStep->GetSecondaryInCurrentStep();
+  for (size_t i=0; i<secondaries->size(); i++) {
+    const G4ParticleDefinition* particle = (*secondaries)[i]->GetParticleDefinition();
+    if (fScorer->GetNuclide(particle->GetAtomicNumber(),
+                            particle->GetAtomicMass()) < 0) continue;
+    // the parent energy is the one before the interaction
+    G4Track* secondary = const_cast<G4Track*>((*secondaries)[i]);
+    secondary->SetUserInformation(new ParentInformation(
+      aStep->GetTrack()->GetParticleDefinition(),
+      aStep->GetPreStepPoint()->GetKineticEnergy()));
+  }
 }
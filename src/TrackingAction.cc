@@ -31,11 +31,16 @@
 #include "TrackingAction.hh"
 
 #include "Run.hh"
+#include "DetectorConstruction.hh"
 #include "EventAction.hh"
 #include "HistoManager.hh"
+#include "NuclideScorer.hh"
+#include "ParentInformation.hh"
+#include "Profiler.hh"
 
 #include "G4RunManager.hh"
 #include "G4Track.hh"
+#include "G4VPhysicalVolume.hh"
 #include "G4StepStatus.hh"
 #include "G4ParticleTypes.hh"
 
@@ -43,129 +48,79 @@
 #include "G4UnitsTable.hh"
 
 
-TrackingAction::TrackingAction(EventAction* event)
-:G4UserTrackingAction(), fEventAction(event)
+TrackingAction::TrackingAction(DetectorConstruction* det, EventAction* event,
+                               NuclideScorer* scorer, Profiler* profiler)
+:G4UserTrackingAction(), fDetector(det), fEventAction(event), fScorer(scorer),
+ fProfiler(profiler)
 {}
 
 
 void TrackingAction::PreUserTrackingAction(const G4Track* track)
 {  
-  //count secondary particles
-  if (track->GetTrackID() == 1) return;  
-  G4String name   = track->GetDefinition()->GetParticleName();
-  G4double energy = track->GetKineticEnergy();
   Run* run = static_cast<Run*>(
         G4RunManager::GetRunManager()->GetNonConstCurrentRun());    
-  run->ParticleCount(name, energy);
+
+  // the first step of the track is timed from here
+  if (fProfiler->IsActive()) run->ProfileTrack(Profiler::Ticks());
+
+  //count secondary particles (not the copies made by importance splitting)
+  if (track->GetTrackID() == 1) return;  
+  if (!track->GetCreatorProcess()) return;
+  const G4ParticleDefinition* particle = track->GetParticleDefinition();
+  G4double energy = track->GetKineticEnergy();
+  run->ParticleCount(particle, energy);
        
-  // histograms: energy at creation
-  G4AnalysisManager* analysis = G4AnalysisManager::Instance();
- 
-  const G4ParticleDefinition* particle = track->GetParticleDefinition();  //particle
-  G4String type = particle->GetParticleType();                            //particle type
-  G4ThreeVector posVector;                                                //particle position (x, y, z)
-  G4double posRadius;                                                     //particle position r
-  G4double depth;                                                         //particle radial depth
-
-  G4double meteoriteRadius = 241*m;	                                      //meteorite radius
-  G4double histogramX = 8*m;                                              //histogram X axis
-  
-  if (type == "nucleus") {
-    G4int atomicNumber = particle->GetAtomicNumber();                     //particle atomic mumber
-    G4int atomicMass = particle->GetAtomicMass();                         //particle atomic mass
-
-    // Al26
-    if(atomicNumber == 13 && atomicMass == 26) {
-      posVector = track->GetPosition(); // Position in which Al26 is created
-      posRadius = sqrt(posVector.getX()*posVector.getX() + posVector.getY()*posVector.getY() + posVector.getZ()*posVector.getZ()); // mm
-      depth = meteoriteRadius - posRadius; // The default unit of measure is mm
-      if(depth <= histogramX)
-        analysis->FillH1(0, depth);
-      // G4cout << "1) Al26 position: " << posRadius << " mm" << G4endl;
-      // G4cout << "2) Al26 depth: " << depth << " mm" << G4endl;
-      // G4cout << "3) Met Radius: " << meteoriteRadius << " mm" << G4endl << G4endl;
-    }
-
-    // Mn54
-    if(atomicNumber == 25 && atomicMass == 54) {
-      posVector = track->GetPosition(); // Position in which Al26 is created
-      posRadius = sqrt(posVector.getX()*posVector.getX() + posVector.getY()*posVector.getY() + posVector.getZ()*posVector.getZ()); // mm
-      depth = meteoriteRadius - posRadius; // The default unit of measure is mm
-      if(depth <= histogramX)
-        analysis->FillH1(1, depth);
-      // G4cout << "Mn54 pos: " << depth/10 << " cm" << G4endl;
-    }
-
-    //Co57
-    if(atomicNumber == 27 && atomicMass == 57) {
-      posVector = track->GetPosition(); // Position in which Al26 is created
-      posRadius = sqrt(posVector.getX()*posVector.getX() + posVector.getY()*posVector.getY() + posVector.getZ()*posVector.getZ()); // mm
-      depth = meteoriteRadius - posRadius; // The default unit of measure is mm
-      if(depth <= histogramX)
-        analysis->FillH1(2, depth);
-      // G4cout << "Co57 pos: " << depth/10 << " cm" << G4endl;
-    }
-
-    //Na22
-    if(atomicNumber == 11 && atomicMass == 22) {
-      posVector = track->GetPosition(); // Position in which Al26 is created
-      posRadius = sqrt(posVector.getX()*posVector.getX() + posVector.getY()*posVector.getY() + posVector.getZ()*posVector.getZ()); // mm
-      depth = meteoriteRadius - posRadius; // The default unit of measure is mm
-      if(depth <= histogramX)
-        analysis->FillH1(3, depth);
-      // G4cout << "Na22 pos: " << posRadius/1000 << G4endl;
-    }
-
-    //Co60
-    if(atomicNumber == 27 && atomicMass == 60) {
-      posVector = track->GetPosition(); // Position in which Al26 is created
-      posRadius = sqrt(posVector.getX()*posVector.getX() + posVector.getY()*posVector.getY() + posVector.getZ()*posVector.getZ()); // mm
-      depth = meteoriteRadius - posRadius; // The default unit of measure is mm
-      if(depth <= histogramX)
-        analysis->FillH1(4, depth);
-      // G4cout << "Co60 pos: " << depth/10 << " cm" << G4endl;
-    }
-
-    //Ti44
-    if(atomicNumber == 22 && atomicMass == 44) {
-      posVector = track->GetPosition(); // Position in which Al26 is created
-      posRadius = sqrt(posVector.getX()*posVector.getX() + posVector.getY()*posVector.getY() + posVector.getZ()*posVector.getZ()); // mm
-      depth = meteoriteRadius - posRadius; // The default unit of measure is mm
-      if(depth <= histogramX)
-        analysis->FillH1(5, depth);
-      // G4cout << "Ti44 pos: " << depth/10 << " cm" << G4endl;
-    }
-
-    //Ca41
-    if(atomicNumber == 20 && atomicMass == 41) {
-      posVector = track->GetPosition(); // Position in which Al26 is created
-      posRadius = sqrt(posVector.getX()*posVector.getX() + posVector.getY()*posVector.getY() + posVector.getZ()*posVector.getZ()); // mm
-      depth = meteoriteRadius - posRadius; // The default unit of measure is mm
-      if(depth <= histogramX)
-        analysis->FillH1(6, depth);
-      // G4cout << "Ca41 pos: " << depth/10 << " cm" << G4endl;
-    }
-
-    //Cl36
-    if(atomicNumber == 17 && atomicMass == 36) {
-      posVector = track->GetPosition(); // Position in which Al26 is created
-      posRadius = sqrt(posVector.getX()*posVector.getX() + posVector.getY()*posVector.getY() + posVector.getZ()*posVector.getZ()); // mm
-      depth = meteoriteRadius - posRadius; // The default unit of measure is mm
-      if(depth <= histogramX)
-        analysis->FillH1(7, depth);
-      // G4cout << "Ca41 pos: " << depth/10 << " cm" << G4endl;
-    }
-
-    //Be10
-    if(atomicNumber == 4 && atomicMass == 10) {
-      posVector = track->GetPosition(); // Position in which Al26 is created
-      posRadius = sqrt(posVector.getX()*posVector.getX() + posVector.getY()*posVector.getY() + posVector.getZ()*posVector.getZ()); // mm
-      depth = meteoriteRadius - posRadius; // The default unit of measure is mm
-      if(depth <= histogramX)
-        analysis->FillH1(8, depth);
-      // G4cout << "Be10 pos: " << depth/10 << " cm" << G4endl;
-    }
+  // histograms: depth of the scored radionuclides at creation
+  G4int nuclide = fScorer->GetNuclide(particle->GetAtomicNumber(),
+                                      particle->GetAtomicMass());
+  if (nuclide < 0) return;
+
+  // weight of the importance biasing, inherited from the parent
+  G4double weight = track->GetWeight();
+
+  // with shells, the shell of creation is the copy number of the
+  // current volume
+  if (fDetector->GetNbShells() > 0) {
+    G4int shell = track->GetVolume()->GetCopyNo() - 1;
+    if (shell < 0) return;
+    run->ShellCount(nuclide, shell, weight);
+  }
 
+  // radial depth with respect to the meteorite surface
+  G4double depth = fDetector->GetRadius() - track->GetPosition().mag();
+  if (depth > fScorer->GetMaxDepth()) return;
+
+  // production channel, tagged by the SteppingAction
+  const ParentInformation* info =
+    static_cast<const ParentInformation*>(track->GetUserInformation());
+  if (info) run->ChannelCount(track->GetCreatorProcess(), info->GetParent(),
+                              nuclide, info->GetEnergy(), weight);
+
+  // record for offline rebinning, at the exact depth of creation
+  if (fScorer->GetRecords()) {
+    G4int parent = info ? info->GetParent()->GetPDGEncoding() : 0;
+    HistoManager::FillRecord(particle->GetAtomicNumber(),
+                             particle->GetAtomicMass(),
+                             depth,
+                             track->GetKineticEnergy(), parent,
+                             fEventAction->GetPrimaryEnergy(), weight);
   }
 
+  // depth profiles of the run, written in the histograms at end of run
+  G4int bin = run->DepthBin(nuclide, depth);
+  if (bin < 0) return;
+  run->FillDepth(nuclide, -1, bin, weight);
+
+  // response matrix, per point of the primary energy grid
+  G4int point = fEventAction->GetResponsePoint();
+  if (point >= 0) run->FillResponse(nuclide, point, bin, weight);
+
+  // split by species of the primary
+  G4int species = fEventAction->GetSpecies();
+  if (species >= 0) run->FillSpecies(nuclide, species, bin, weight);
+
+  // reweighted to the other modulation parameters
+  for (G4int iphi=0; iphi<fScorer->GetNbPhi(); iphi++) {
+    run->FillDepth(nuclide, iphi, bin, weight*fEventAction->GetPhiWeight(iphi));
+  }
 }